@@ -0,0 +1,58 @@
+#include "Camera.h"
+
+void Camera::Initialize(const Transform& transform, float aspectRatio) {
+	transform_ = transform;
+	aspectRatio_ = aspectRatio;
+	isViewDirty_ = true;
+	isProjectionDirty_ = true;
+
+	// 最初の行列を作っておく
+	Update();
+}
+
+void Camera::Update() {
+	// 変更がなければ何もしない
+	if (!isViewDirty_ && !isProjectionDirty_) {
+		return;
+	}
+
+	// ビュー行列
+	if (isViewDirty_) {
+		viewMatrix_ = matrix_.MakeViewMatrix(transform_);
+		isViewDirty_ = false;
+	}
+
+	// プロジェクション行列
+	if (isProjectionDirty_) {
+		projectionMatrix_ = matrix_.MakePerspectiveFovMatrix(fovY_, aspectRatio_, nearClip_, farClip_);
+		isProjectionDirty_ = false;
+	}
+
+	// ビュープロジェクション行列
+	viewProjectionMatrix_ = matrix_.Multiply(viewMatrix_, projectionMatrix_);
+}
+
+void Camera::SetTransform(const Transform& transform) {
+	transform_ = transform;
+	isViewDirty_ = true;
+}
+
+void Camera::SetFovY(float fovY) {
+	fovY_ = fovY;
+	isProjectionDirty_ = true;
+}
+
+void Camera::SetAspectRatio(float aspectRatio) {
+	aspectRatio_ = aspectRatio;
+	isProjectionDirty_ = true;
+}
+
+void Camera::SetNearClip(float nearClip) {
+	nearClip_ = nearClip;
+	isProjectionDirty_ = true;
+}
+
+void Camera::SetFarClip(float farClip) {
+	farClip_ = farClip;
+	isProjectionDirty_ = true;
+}
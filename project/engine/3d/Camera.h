@@ -0,0 +1,55 @@
+#pragma once
+#include "engine/math/Matrix.h"
+
+// カメラ
+// ビュー行列・プロジェクション行列は変更があった時だけUpdateで作り直す
+class Camera {
+public:
+	// 初期化
+	void Initialize(const Transform& transform, float aspectRatio);
+
+	// 更新
+	void Update();
+
+	// setter
+	void SetTransform(const Transform& transform);
+	void SetFovY(float fovY);
+	void SetAspectRatio(float aspectRatio);
+	void SetNearClip(float nearClip);
+	void SetFarClip(float farClip);
+
+	// getter
+	const Transform& GetTransform() const { return transform_; }
+	float GetFovY() const { return fovY_; }
+	float GetAspectRatio() const { return aspectRatio_; }
+	float GetNearClip() const { return nearClip_; }
+	float GetFarClip() const { return farClip_; }
+	const Matrix4x4& GetViewMatrix() const { return viewMatrix_; }
+	const Matrix4x4& GetProjectionMatrix() const { return projectionMatrix_; }
+	const Matrix4x4& GetViewProjectionMatrix() const { return viewProjectionMatrix_; }
+
+private:
+	// 数学関数
+	Matrix matrix_;
+
+	// カメラの座標変換
+	Transform transform_ = { {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f} };
+
+	// 垂直方向の画角
+	float fovY_ = 0.45f;
+	// アスペクト比
+	float aspectRatio_ = 1.0f;
+	// ニアクリップ距離
+	float nearClip_ = 0.1f;
+	// ファークリップ距離
+	float farClip_ = 100.0f;
+
+	// キャッシュした行列
+	Matrix4x4 viewMatrix_ = {};
+	Matrix4x4 projectionMatrix_ = {};
+	Matrix4x4 viewProjectionMatrix_ = {};
+
+	// 作り直しが必要か
+	bool isViewDirty_ = true;
+	bool isProjectionDirty_ = true;
+};
@@ -0,0 +1,78 @@
+#include "MeshBounds.h"
+#include "engine/math/Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+	// getPosition(i)（i = 0～count - 1）の最小と最大
+	template <typename GetPosition>
+	AABB ComputeAABB(size_t count, GetPosition&& getPosition) {
+#ifdef MATH_USE_SSE
+		// positionはVector4なので1頂点を1回で読める。wも混ざるが使わない
+		__m128 minimum = _mm_set1_ps(INFINITY);
+		__m128 maximum = _mm_set1_ps(-INFINITY);
+		for (size_t i = 0; i < count; i++) {
+			const __m128 position = _mm_loadu_ps(&getPosition(i).x);
+			minimum = _mm_min_ps(minimum, position);
+			maximum = _mm_max_ps(maximum, position);
+		}
+		alignas(16) float minimumValues[4];
+		alignas(16) float maximumValues[4];
+		_mm_store_ps(minimumValues, minimum);
+		_mm_store_ps(maximumValues, maximum);
+		return { { minimumValues[0], minimumValues[1], minimumValues[2] }, { maximumValues[0], maximumValues[1], maximumValues[2] } };
+#else
+		AABB aabb = { { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } };
+		for (size_t i = 0; i < count; i++) {
+			const Vector4& position = getPosition(i);
+			aabb.min = { std::min(aabb.min.x, position.x), std::min(aabb.min.y, position.y), std::min(aabb.min.z, position.z) };
+			aabb.max = { std::max(aabb.max.x, position.x), std::max(aabb.max.y, position.y), std::max(aabb.max.z, position.z) };
+		}
+		return aabb;
+#endif
+	}
+}
+
+MeshBounds ComputeMeshBounds(std::span<const VertexData> vertices, std::span<const uint32_t> indices) {
+	MeshBounds bounds = {};
+	std::vector<Vector3> points;
+	if (indices.empty()) {
+		if (vertices.empty()) {
+			return bounds;
+		}
+		bounds.aabb = ComputeAABB(vertices.size(), [&](size_t i) -> const Vector4& { return vertices[i].position; });
+		points.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++) {
+			points[i] = { vertices[i].position.x, vertices[i].position.y, vertices[i].position.z };
+		}
+	} else {
+		// 同じ頂点が何度も出てくるので、球は使われている頂点だけで作る
+		bounds.aabb = ComputeAABB(indices.size(), [&](size_t i) -> const Vector4& { return vertices[indices[i]].position; });
+		std::vector<uint32_t> usedVertices(indices.begin(), indices.end());
+		std::sort(usedVertices.begin(), usedVertices.end());
+		usedVertices.erase(std::unique(usedVertices.begin(), usedVertices.end()), usedVertices.end());
+		points.resize(usedVertices.size());
+		for (size_t i = 0; i < usedVertices.size(); i++) {
+			const Vector4& position = vertices[usedVertices[i]].position;
+			points[i] = { position.x, position.y, position.z };
+		}
+	}
+	bounds.sphere = MakeBoundingSphere(points);
+	return bounds;
+}
+
+void ComputeModelBounds(ModelData& modelData) {
+	modelData.bounds = ComputeMeshBounds(modelData.verticles);
+	for (SubmeshData& submesh : modelData.submeshes) {
+		if (submesh.indexCount == 0) {
+			submesh.bounds = {};
+		} else if (modelData.indices.empty()) {
+			const std::span<const VertexData> vertices(modelData.verticles);
+			submesh.bounds = ComputeMeshBounds(vertices.subspan(submesh.indexOffset, submesh.indexCount));
+		} else {
+			const std::span<const uint32_t> indices(modelData.indices);
+			submesh.bounds = ComputeMeshBounds(modelData.verticles, indices.subspan(submesh.indexOffset, submesh.indexCount));
+		}
+	}
+}
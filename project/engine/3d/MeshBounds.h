@@ -0,0 +1,11 @@
+#pragma once
+#include "ModelData.h"
+#include <cstdint>
+#include <span>
+
+// indicesで参照される頂点を囲む境界を求める。indicesが空ならすべての頂点を囲む
+// 境界箱はSIMDで最小・最大を取り、球はRitterの方法で作る
+MeshBounds ComputeMeshBounds(std::span<const VertexData> vertices, std::span<const uint32_t> indices = {});
+
+// メッシュ全体とサブメッシュごとの境界を求め、modelData.boundsとsubmeshes[i].boundsに入れる
+void ComputeModelBounds(ModelData& modelData);
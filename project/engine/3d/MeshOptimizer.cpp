@@ -0,0 +1,248 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+	// 位置をVector3で取り出す
+	Vector3 GetPosition(const VertexData& vertex) {
+		return { vertex.position.x, vertex.position.y, vertex.position.z };
+	}
+}
+
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	// 頂点がキャッシュに入った時刻。現在の時刻との差がcacheSize以下ならまだキャッシュにある
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t> isUsed(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	VertexCacheStatistics statistics = {};
+	size_t usedVertexCount = 0;
+	for (uint32_t index : indices) {
+		if (time - cacheTime[index] > cacheSize) {
+			cacheTime[index] = time++;
+			statistics.vertexTransformCount++;
+		}
+		if (!isUsed[index]) {
+			isUsed[index] = 1;
+			usedVertexCount++;
+		}
+	}
+	if (indices.size() >= 3) {
+		statistics.acmr = float(statistics.vertexTransformCount) / float(indices.size() / 3);
+	}
+	if (usedVertexCount != 0) {
+		statistics.atvr = float(statistics.vertexTransformCount) / float(usedVertexCount);
+	}
+	return statistics;
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// 頂点ごとに、その頂点を使う三角形の一覧を作る
+	std::vector<uint32_t> liveCounts(vertexCount, 0); // まだ出力していない三角形の数
+	for (uint32_t index : indices) {
+		liveCounts[index]++;
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveCounts[vertex];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			adjacency[cursors[indices[i]]++] = uint32_t(i / 3);
+		}
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t> isEmitted(triangleCount, 0);
+	std::vector<uint32_t> deadEndStack; // 出力した頂点。行き止まりになったらここから次の頂点を探す
+	std::vector<uint32_t> candidates; // 直前の扇で出力した頂点
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0; // 行き止まりで、スタックも空になったときに頂点を順に探す位置
+
+	int64_t fanningVertex = indices[0];
+	while (fanningVertex >= 0) {
+		// 扇の中心の頂点を使う三角形をすべて出力する
+		candidates.clear();
+		for (uint32_t a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1]; a++) {
+			const uint32_t triangle = adjacency[a];
+			if (isEmitted[triangle]) {
+				continue;
+			}
+			isEmitted[triangle] = 1;
+			for (size_t k = 0; k < 3; k++) {
+				const uint32_t vertex = indices[triangle * 3 + k];
+				output.push_back(vertex);
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				liveCounts[vertex]--;
+				if (time - cacheTime[vertex] > cacheSize) {
+					cacheTime[vertex] = time++;
+				}
+			}
+		}
+
+		// 次の扇の中心は、その扇を出力してもキャッシュから追い出されない頂点のうち、一番古いもの
+		fanningVertex = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (liveCounts[vertex] == 0) {
+				continue;
+			}
+			int64_t priority = 0;
+			if (time - cacheTime[vertex] + 2 * liveCounts[vertex] <= cacheSize) {
+				priority = time - cacheTime[vertex];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				fanningVertex = vertex;
+			}
+		}
+
+		// 行き止まりなら、最近出力した頂点、それもなければ番号順に残っている頂点を探す
+		while (fanningVertex < 0 && !deadEndStack.empty()) {
+			const uint32_t vertex = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveCounts[vertex] > 0) {
+				fanningVertex = vertex;
+			}
+		}
+		while (fanningVertex < 0 && cursor < vertexCount) {
+			if (liveCounts[cursor] > 0) {
+				fanningVertex = int64_t(cursor);
+			}
+			cursor++;
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices, const std::vector<VertexData>& vertices, uint32_t cacheSize) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount < 2) {
+		return;
+	}
+
+	// キャッシュを再現し、3頂点ともキャッシュにない三角形からを新しいまとまりとする
+	// まとまりの中の順番は変えないので、並べ替えても頂点キャッシュの効率はほとんど落ちない
+	std::vector<uint32_t> cacheTime(vertices.size(), 0);
+	uint32_t time = cacheSize + 1;
+	std::vector<size_t> clusterBegins;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		uint32_t missCount = 0;
+		for (size_t k = 0; k < 3; k++) {
+			const uint32_t vertex = indices[triangle * 3 + k];
+			if (time - cacheTime[vertex] > cacheSize) {
+				cacheTime[vertex] = time++;
+				missCount++;
+			}
+		}
+		if (triangle == 0 || missCount == 3) {
+			clusterBegins.push_back(triangle);
+		}
+	}
+	clusterBegins.push_back(triangleCount);
+	const size_t clusterCount = clusterBegins.size() - 1;
+	if (clusterCount < 2) {
+		return;
+	}
+
+	// まとまりごとの面積で重み付けした中心と法線
+	std::vector<Vector3> clusterCenters(clusterCount);
+	std::vector<Vector3> clusterNormals(clusterCount);
+	Vector3 meshCenter = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		Vector3 center = { 0.0f, 0.0f, 0.0f };
+		Vector3 normal = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+		for (size_t triangle = clusterBegins[cluster]; triangle < clusterBegins[cluster + 1]; triangle++) {
+			const Vector3 p0 = GetPosition(vertices[indices[triangle * 3 + 0]]);
+			const Vector3 p1 = GetPosition(vertices[indices[triangle * 3 + 1]]);
+			const Vector3 p2 = GetPosition(vertices[indices[triangle * 3 + 2]]);
+			// 表面は時計回りなので、この外積が外向きの法線になる
+			const Vector3 triangleNormal = Cross(p1 - p0, p2 - p0);
+			const float triangleArea = Length(triangleNormal);
+			center = center + (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normal = normal + triangleNormal;
+			area += triangleArea;
+		}
+		clusterCenters[cluster] = area > 0.0f ? center * (1.0f / area) : GetPosition(vertices[indices[clusterBegins[cluster] * 3]]);
+		clusterNormals[cluster] = normal;
+		meshCenter = meshCenter + center;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) {
+		meshCenter = meshCenter * (1.0f / meshArea);
+	}
+
+	// メッシュの中心から外向きに離れているまとまりほど、ほかの面を隠しやすいので先に描く
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++) {
+		const float length = Length(clusterNormals[cluster]);
+		sortKeys[cluster] = length > 0.0f ? Dot(clusterCenters[cluster] - meshCenter, clusterNormals[cluster]) / length : 0.0f;
+	}
+	std::vector<size_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (size_t cluster : order) {
+		output.insert(output.end(), indices.begin() + clusterBegins[cluster] * 3, indices.begin() + clusterBegins[cluster + 1] * 3);
+	}
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void OptimizeVertexFetch(ModelData& modelData) {
+	// 初めて参照された順に新しい番号を振る
+	const uint32_t kUnused = 0xFFFFFFFF;
+	std::vector<uint32_t> remap(modelData.verticles.size(), kUnused);
+	std::vector<VertexData> verticles;
+	std::vector<Vector4> tangents;
+	verticles.reserve(modelData.verticles.size());
+	tangents.reserve(modelData.tangents.size());
+	for (uint32_t& index : modelData.indices) {
+		if (remap[index] == kUnused) {
+			remap[index] = uint32_t(verticles.size());
+			verticles.push_back(modelData.verticles[index]);
+			if (!modelData.tangents.empty()) {
+				tangents.push_back(modelData.tangents[index]);
+			}
+		}
+		index = remap[index];
+	}
+	modelData.verticles = std::move(verticles);
+	modelData.tangents = std::move(tangents);
+}
+
+void OptimizeMesh(ModelData& modelData) {
+	if (modelData.indices.empty()) {
+		return;
+	}
+
+	// サブメッシュをまたいで三角形を動かすと描画範囲が壊れるので、範囲ごとに並べ替える
+	std::span<uint32_t> indices = modelData.indices;
+	auto optimize = [&](std::span<uint32_t> range) {
+		OptimizeVertexCache(range, modelData.verticles.size());
+		OptimizeOverdraw(range, modelData.verticles);
+	};
+	if (modelData.submeshes.empty()) {
+		optimize(indices);
+	} else {
+		for (const SubmeshData& submesh : modelData.submeshes) {
+			optimize(indices.subspan(submesh.indexOffset, submesh.indexCount));
+		}
+	}
+	OptimizeVertexFetch(modelData);
+}
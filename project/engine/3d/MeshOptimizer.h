@@ -0,0 +1,31 @@
+#pragma once
+#include "ModelData.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// GPUの頂点変換後キャッシュを想定したFIFOのサイズ
+const uint32_t kVertexCacheSize = 16;
+
+// 頂点キャッシュの統計
+struct VertexCacheStatistics {
+	uint32_t vertexTransformCount; // キャッシュに乗らず頂点シェーダーが走った回数
+	float acmr; // 三角形あたりの頂点変換数（Average Cache Miss Ratio）。0.5に近いほど良い
+	float atvr; // 使われている頂点あたりの頂点変換数（Average Transformed Vertex Ratio）。1に近いほど良い
+};
+
+// indicesをFIFOキャッシュで描いたときの頂点変換数を数える
+VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+// 頂点キャッシュに乗りやすいよう三角形の順番を並べ替える（Tipsify）
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+// キャッシュが途切れる所で三角形をまとまりに分け、外側を向いたまとまりから先に描くよう並べ替える
+// 手前の面が先に描かれやすくなり、深度テストで後ろの面のピクセルシェーダーを省ける
+void OptimizeOverdraw(std::span<uint32_t> indices, const std::vector<VertexData>& vertices, uint32_t cacheSize = kVertexCacheSize);
+
+// 頂点を初めて参照される順に並べ替え、indicesを付け替える。使われていない頂点は取り除く（接線も同じように並べ替える）
+void OptimizeVertexFetch(ModelData& modelData);
+
+// サブメッシュごとに上の3つをかける。indicesがなければ何もしない
+void OptimizeMesh(ModelData& modelData);
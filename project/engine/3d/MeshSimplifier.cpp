@@ -0,0 +1,407 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace {
+	// 境界の辺に垂直な平面の重み。境界が縮んで穴が広がらないよう、面より強く効かせる
+	const double kBoundaryWeight = 10.0;
+	// UVや法線の継ぎ目の辺に垂直な平面の重み。継ぎ目の線が崩れないよう、面と同じくらい効かせる
+	const double kSeamWeight = 1.0;
+
+	// 縮約で動く三角形の、法線の向きの変化の許容範囲（cos）
+	const float kMinNormalCos = 0.25f;
+
+	// 同じ位置の頂点を、継ぎ目ではなく同じ頂点とみなす法線の向きの差（cos）とUVの差
+	// フラットシェーディングのように面ごとに分かれた頂点も、なだらかな所なら縮約できる
+	const float kWedgeNormalCos = 0.9f;
+	const float kWedgeTexcoordEpsilon = 1.0f / 4096.0f;
+
+	// 1回の繰り返しでまとめて行う縮約の誤差の上限。必要な数番目の候補の誤差に対する倍率
+	const float kPassErrorScale = 1.5f;
+
+	// 二次誤差。平面までの距離の2乗和を表す対称4x4行列の10要素と、面積の合計
+	struct Quadric {
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	// 平面 n・p + d = 0 を重みweightで足す
+	void AddPlane(Quadric& q, const Vector3& n, double d, double weight) {
+		q.a00 += weight * n.x * n.x; q.a01 += weight * n.x * n.y; q.a02 += weight * n.x * n.z;
+		q.a11 += weight * n.y * n.y; q.a12 += weight * n.y * n.z; q.a22 += weight * n.z * n.z;
+		q.b0 += weight * n.x * d; q.b1 += weight * n.y * d; q.b2 += weight * n.z * d;
+		q.c += weight * d * d;
+	}
+
+	void AddQuadric(Quadric& q, const Quadric& other) {
+		q.a00 += other.a00; q.a01 += other.a01; q.a02 += other.a02;
+		q.a11 += other.a11; q.a12 += other.a12; q.a22 += other.a22;
+		q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+		q.c += other.c;
+		q.weight += other.weight;
+	}
+
+	// 点pでの誤差。面積で割って平均の距離にする
+	double Evaluate(const Quadric& q, const Vector3& p) {
+		const double x = p.x, y = p.y, z = p.z;
+		double error = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z + 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+			2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+		error = std::max(error, 0.0);
+		return q.weight > 0.0 ? std::sqrt(error / q.weight) : std::sqrt(error);
+	}
+
+	Vector3 GetPosition(const VertexData& vertex) {
+		return { vertex.position.x, vertex.position.y, vertex.position.z };
+	}
+
+	// 同じ位置の2つの頂点のUVと法線が、継ぎ目とみなさなくてよいほど近いか
+	bool IsSameWedge(const VertexData& a, const VertexData& b) {
+		return std::abs(a.texcoord.x - b.texcoord.x) <= kWedgeTexcoordEpsilon && std::abs(a.texcoord.y - b.texcoord.y) <= kWedgeTexcoordEpsilon &&
+			Dot(a.normal, b.normal) >= kWedgeNormalCos * Length(a.normal) * Length(b.normal);
+	}
+
+	// 辺の縮約の候補
+	struct Collapse {
+		uint32_t from; // 位置の番号
+		uint32_t to;
+		float error;
+	};
+}
+
+float SimplifyIndices(std::vector<uint32_t>& destination, std::span<const uint32_t> indices, const std::vector<VertexData>& vertices,
+	size_t targetIndexCount, float maxError) {
+	destination.assign(indices.begin(), indices.end());
+	if (destination.size() <= targetIndexCount) {
+		return 0.0f;
+	}
+
+	// 同じ位置の頂点に同じ番号を振る。UVや法線が大きく違う頂点は継ぎ目の両側の頂点になる
+	std::vector<uint32_t> usedVertices(indices.begin(), indices.end());
+	std::sort(usedVertices.begin(), usedVertices.end());
+	usedVertices.erase(std::unique(usedVertices.begin(), usedVertices.end()), usedVertices.end());
+	// 位置のビット列で並べて、隣り合う同じ位置をまとめる
+	struct PositionKey {
+		uint32_t bits[3];
+		uint32_t vertex;
+	};
+	std::vector<PositionKey> keys(usedVertices.size());
+	for (size_t i = 0; i < usedVertices.size(); i++) {
+		keys[i].vertex = usedVertices[i];
+		std::memcpy(keys[i].bits, &vertices[usedVertices[i]].position, sizeof(keys[i].bits));
+	}
+	auto isSamePosition = [](const PositionKey& a, const PositionKey& b) {
+		return a.bits[0] == b.bits[0] && a.bits[1] == b.bits[1] && a.bits[2] == b.bits[2];
+	};
+	std::sort(keys.begin(), keys.end(), [](const PositionKey& a, const PositionKey& b) {
+		return std::tie(a.bits[0], a.bits[1], a.bits[2], a.vertex) < std::tie(b.bits[0], b.bits[1], b.bits[2], b.vertex);
+	});
+	const uint32_t kNone = 0xFFFFFFFF;
+	std::vector<uint32_t> positionOf(vertices.size(), kNone); // 頂点から位置の番号
+	std::vector<uint32_t> wedgeOf(vertices.size(), kNone); // 頂点から、同じ位置でUVと法線の近い頂点の代表
+	std::vector<Vector3> positions;
+	size_t positionStart = 0;
+	for (size_t i = 0; i < keys.size(); i++) {
+		const uint32_t vertex = keys[i].vertex;
+		if (i == 0 || !isSamePosition(keys[i - 1], keys[i])) {
+			positions.push_back(GetPosition(vertices[vertex]));
+			positionStart = i;
+		}
+		positionOf[vertex] = uint32_t(positions.size() - 1);
+		wedgeOf[vertex] = vertex;
+		for (size_t j = positionStart; j < i; j++) {
+			const uint32_t other = keys[j].vertex;
+			if (wedgeOf[other] == other && IsSameWedge(vertices[other], vertices[vertex])) {
+				wedgeOf[vertex] = other;
+				break;
+			}
+		}
+	}
+	const size_t positionCount = positions.size();
+
+	// 面の平面と、境界や継ぎ目の辺に垂直な平面から二次誤差を作る
+	std::vector<Quadric> quadrics(positionCount, Quadric{});
+	// 位置ごとの、元の面の法線（面積の重み付き）の和。縮約でまとめた位置の分も足していく
+	std::vector<Vector3> sourceNormals(positionCount, Vector3{ 0.0f, 0.0f, 0.0f });
+	std::vector<std::pair<uint32_t, uint32_t>> edges; // 向き付きの辺（位置の番号）
+	std::vector<std::pair<uint32_t, uint32_t>> vertexEdges; // 向き付きの辺（頂点の代表の番号）
+	edges.reserve(destination.size());
+	vertexEdges.reserve(destination.size());
+	for (size_t i = 0; i < destination.size(); i += 3) {
+		const uint32_t corners[3] = { positionOf[destination[i]], positionOf[destination[i + 1]], positionOf[destination[i + 2]] };
+		const Vector3 normal = Cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+		const float length = Length(normal);
+		if (length == 0.0f) {
+			continue;
+		}
+		const Vector3 n = normal * (1.0f / length);
+		const double area = 0.5 * length;
+		for (uint32_t corner : corners) {
+			AddPlane(quadrics[corner], n, -Dot(n, positions[corners[0]]), area);
+			quadrics[corner].weight += area;
+			sourceNormals[corner] += normal;
+		}
+		for (size_t k = 0; k < 3; k++) {
+			edges.push_back({ corners[k], corners[(k + 1) % 3] });
+			vertexEdges.push_back({ wedgeOf[destination[i + k]], wedgeOf[destination[i + (k + 1) % 3]] });
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	std::sort(vertexEdges.begin(), vertexEdges.end());
+	for (size_t i = 0; i < destination.size(); i += 3) {
+		const uint32_t corners[3] = { positionOf[destination[i]], positionOf[destination[i + 1]], positionOf[destination[i + 2]] };
+		const Vector3 normal = Cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+		if (LengthSquared(normal) == 0.0f) {
+			continue;
+		}
+		for (size_t k = 0; k < 3; k++) {
+			// 逆向きの辺がなければ境界。あっても頂点が違えば継ぎ目
+			const uint32_t a = corners[k], b = corners[(k + 1) % 3];
+			double edgeWeight = kBoundaryWeight;
+			if (std::binary_search(edges.begin(), edges.end(), std::make_pair(b, a))) {
+				if (std::binary_search(vertexEdges.begin(), vertexEdges.end(), std::make_pair(wedgeOf[destination[i + (k + 1) % 3]], wedgeOf[destination[i + k]]))) {
+					continue;
+				}
+				edgeWeight = kSeamWeight;
+			}
+			const Vector3 edge = positions[b] - positions[a];
+			const Vector3 perpendicular = Cross(edge, normal);
+			const float length = Length(perpendicular);
+			if (length == 0.0f) {
+				continue;
+			}
+			const Vector3 n = perpendicular * (1.0f / length);
+			const double weight = edgeWeight * LengthSquared(edge);
+			AddPlane(quadrics[a], n, -Dot(n, positions[a]), weight);
+			AddPlane(quadrics[b], n, -Dot(n, positions[a]), weight);
+		}
+	}
+
+	// 縮約をまとめて選んでは適用する、を目標の三角形数になるまで繰り返す
+	float resultError = 0.0f;
+	std::vector<uint32_t> adjacencyOffsets(positionCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t> isTouched(positionCount);
+	std::vector<uint32_t> bestTargets(positionCount);
+	std::vector<float> bestErrors(positionCount);
+	std::vector<uint32_t> remap(vertices.size());
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeRemap; // 縮約1回分の、縮約元の頂点の代表と付け替え先
+	std::vector<uint32_t> remainingWedges; // 縮約1回分の、残る三角形にある縮約元の頂点の代表
+	while (destination.size() > targetIndexCount) {
+		// 位置ごとの、その位置を使う三角形の一覧
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t vertex : destination) {
+			adjacencyOffsets[positionOf[vertex] + 1]++;
+		}
+		std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+		adjacency.resize(destination.size());
+		{
+			std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < destination.size(); i++) {
+				adjacency[cursors[positionOf[destination[i]]]++] = uint32_t(i / 3);
+			}
+		}
+
+		// 位置ごとに、隣の位置のうち縮約したときの誤差が一番小さいものを候補にする
+		std::fill(bestTargets.begin(), bestTargets.end(), kNone);
+		for (size_t i = 0; i < destination.size(); i += 3) {
+			for (size_t k = 0; k < 3; k++) {
+				const uint32_t from = positionOf[destination[i + k]];
+				for (size_t j = 1; j < 3; j++) {
+					const uint32_t to = positionOf[destination[i + (k + j) % 3]];
+					Quadric q = quadrics[from];
+					AddQuadric(q, quadrics[to]);
+					const float error = float(Evaluate(q, positions[to]));
+					if (bestTargets[from] == kNone || error < bestErrors[from]) {
+						bestTargets[from] = to;
+						bestErrors[from] = error;
+					}
+				}
+			}
+		}
+		collapses.clear();
+		for (uint32_t from = 0; from < positionCount; from++) {
+			if (bestTargets[from] != kNone && bestErrors[from] <= maxError) {
+				collapses.push_back({ from, bestTargets[from], bestErrors[from] });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+		// 誤差の小さい順に適用する。同じ回では周りの頂点が動いていないものだけを縮約する
+		std::fill(isTouched.begin(), isTouched.end(), 0);
+		std::iota(remap.begin(), remap.end(), 0u);
+		size_t removableIndexCount = destination.size() - targetIndexCount;
+		if (collapses.empty()) {
+			break; // これ以上縮約できない
+		}
+		// 1回の縮約で三角形はおよそ2つ減る。必要な数より大幅に誤差の大きい縮約は次の回に回す
+		const size_t wantedCount = std::clamp<size_t>((removableIndexCount / 3 + 1) / 2, 1, collapses.size());
+		const float passMaxError = collapses[wantedCount - 1].error * kPassErrorScale;
+		size_t collapseCount = 0;
+		for (const Collapse& collapse : collapses) {
+			if (removableIndexCount == 0 || collapse.error > passMaxError) {
+				break;
+			}
+			if (isTouched[collapse.from] || isTouched[collapse.to]) {
+				continue;
+			}
+
+			// 縮約元の頂点ごとに、縮約する辺を含む三角形で隣にある縮約先の頂点へ付け替える
+			// 継ぎ目の頂点は両側の三角形がそれぞれの側の頂点を決めるので、継ぎ目に沿った辺なら縮約できる
+			// 付け替え先が三角形によって違うか、辺を含む三角形のない頂点が残れば継ぎ目をまたぐのでやめる
+			wedgeRemap.clear();
+			remainingWedges.clear();
+			bool isValid = true;
+			uint32_t removedTriangleCount = 0;
+			const Vector3& toPosition = positions[collapse.to];
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1] && isValid; a++) {
+				const uint32_t* triangle = &destination[adjacency[a] * 3];
+				uint32_t fromVertex = kNone;
+				uint32_t sharedVertex = kNone;
+				for (size_t k = 0; k < 3; k++) {
+					if (positionOf[triangle[k]] == collapse.from) {
+						fromVertex = triangle[k];
+					} else if (positionOf[triangle[k]] == collapse.to) {
+						sharedVertex = triangle[k];
+					}
+				}
+				const uint32_t fromWedge = wedgeOf[fromVertex];
+				if (sharedVertex != kNone) {
+					const auto wedgeIt = std::find_if(wedgeRemap.begin(), wedgeRemap.end(), [&](const auto& wedge) { return wedge.first == fromWedge; });
+					if (wedgeIt == wedgeRemap.end()) {
+						wedgeRemap.push_back({ fromWedge, sharedVertex });
+					} else {
+						isValid = wedgeOf[wedgeIt->second] == wedgeOf[sharedVertex];
+					}
+					removedTriangleCount++;
+					continue;
+				}
+				remainingWedges.push_back(fromWedge);
+				// 残る三角形の向きが大きく変わる（裏返る）ならやめる
+				Vector3 corners[3];
+				Vector3 movedCorners[3];
+				for (size_t k = 0; k < 3; k++) {
+					corners[k] = positions[positionOf[triangle[k]]];
+					movedCorners[k] = positionOf[triangle[k]] == collapse.from ? toPosition : corners[k];
+				}
+				const Vector3 before = Cross(corners[1] - corners[0], corners[2] - corners[0]);
+				const Vector3 after = Cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+				isValid = Dot(before, after) > kMinNormalCos * Length(before) * Length(after);
+				// 縮約を重ねて少しずつ傾き、元の面から見て裏返ることもないようにする
+				for (size_t k = 0; k < 3 && isValid; k++) {
+					const uint32_t corner = positionOf[triangle[k]];
+					const Vector3 sourceNormal = corner == collapse.from ? sourceNormals[collapse.from] + sourceNormals[collapse.to] : sourceNormals[corner];
+					isValid = Dot(after, sourceNormal) > 0.0f;
+				}
+			}
+			for (size_t i = 0; i < remainingWedges.size() && isValid; i++) {
+				isValid = std::any_of(wedgeRemap.begin(), wedgeRemap.end(), [&](const auto& wedge) { return wedge.first == remainingWedges[i]; });
+			}
+			if (!isValid || wedgeRemap.empty()) {
+				continue;
+			}
+
+			// 縮約する。周りの頂点はこの回ではもう動かさない
+			for (uint32_t a = adjacencyOffsets[collapse.from]; a < adjacencyOffsets[collapse.from + 1]; a++) {
+				for (size_t k = 0; k < 3; k++) {
+					const uint32_t vertex = destination[adjacency[a] * 3 + k];
+					if (positionOf[vertex] == collapse.from) {
+						remap[vertex] = std::find_if(wedgeRemap.begin(), wedgeRemap.end(), [&](const auto& wedge) { return wedge.first == wedgeOf[vertex]; })->second;
+					}
+					isTouched[positionOf[vertex]] = 1;
+				}
+			}
+			AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			sourceNormals[collapse.to] += sourceNormals[collapse.from];
+			resultError = std::max(resultError, collapse.error);
+			removableIndexCount -= std::min<size_t>(removableIndexCount, removedTriangleCount * 3);
+			collapseCount++;
+		}
+		if (collapseCount == 0) {
+			break; // これ以上縮約できない
+		}
+
+		// 頂点を付け替え、つぶれて面積のなくなった三角形を取り除く
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < destination.size(); i += 3) {
+			const uint32_t v0 = remap[destination[i]], v1 = remap[destination[i + 1]], v2 = remap[destination[i + 2]];
+			const uint32_t p0 = positionOf[v0], p1 = positionOf[v1], p2 = positionOf[v2];
+			if (p0 == p1 || p1 == p2 || p2 == p0 || LengthSquared(Cross(positions[p1] - positions[p0], positions[p2] - positions[p0])) == 0.0f) {
+				continue;
+			}
+			destination[writeIndex++] = v0;
+			destination[writeIndex++] = v1;
+			destination[writeIndex++] = v2;
+		}
+		destination.resize(writeIndex);
+	}
+
+	return resultError;
+}
+
+std::vector<MeshLod> BuildLodChain(ModelData& modelData, const LodOptions& options) {
+	// 先頭は元のメッシュ
+	std::vector<MeshLod> lods(1);
+	lods[0].submeshes = modelData.submeshes;
+	if (lods[0].submeshes.empty()) {
+		lods[0].submeshes.push_back({ "", 0, uint32_t(modelData.indices.size()), 0, modelData.bounds });
+	}
+	lods[0].error = 0.0f;
+	if (modelData.indices.empty()) {
+		return lods;
+	}
+
+	std::vector<uint32_t> source;
+	std::vector<uint32_t> simplified;
+	for (float ratio : options.triangleRatios) {
+		// 1つ前の段から簡略化する。誤差は段ごとの誤差を足して上限の目安にする
+		const MeshLod& previous = lods.back();
+		MeshLod lod;
+		lod.error = 0.0f;
+		size_t previousIndexCount = 0;
+		size_t indexCount = 0;
+		for (size_t i = 0; i < previous.submeshes.size(); i++) {
+			const SubmeshData& submesh = previous.submeshes[i];
+			const size_t originalTriangleCount = lods[0].submeshes[i].indexCount / 3;
+			const size_t targetIndexCount = std::max<size_t>(1, size_t(float(originalTriangleCount) * ratio)) * 3;
+			source.assign(modelData.indices.begin() + submesh.indexOffset, modelData.indices.begin() + submesh.indexOffset + submesh.indexCount);
+			lod.error = std::max(lod.error, SimplifyIndices(simplified, source, modelData.verticles, targetIndexCount, options.maxError));
+			OptimizeVertexCache(simplified, modelData.verticles.size());
+			// 頂点は元の頂点の一部なので、元の境界で囲める
+			lod.submeshes.push_back({ submesh.name, uint32_t(modelData.indices.size()), uint32_t(simplified.size()), submesh.materialIndex, submesh.bounds });
+			modelData.indices.insert(modelData.indices.end(), simplified.begin(), simplified.end());
+			previousIndexCount += submesh.indexCount;
+			indexCount += simplified.size();
+		}
+		lod.error += previous.error;
+
+		// 1割も減らなければ、これより粗い段は作らない
+		if (indexCount * 10 > previousIndexCount * 9) {
+			modelData.indices.resize(lod.submeshes.front().indexOffset);
+			break;
+		}
+		lods.push_back(lod);
+	}
+
+	return lods;
+}
+
+size_t SelectLod(std::span<const MeshLod> lods, float distance, const Matrix4x4& projection, float viewportHeight, float maxPixelError) {
+	if (lods.empty() || distance <= 0.0f) {
+		return 0;
+	}
+	// 距離distanceでの1の長さが画面上で何ピクセルになるか。透視投影のm[1][1]は1/tan(fovY/2)
+	const float pixelsPerUnit = projection.m[1][1] / distance * viewportHeight * 0.5f;
+	for (size_t lod = lods.size(); lod-- > 1;) {
+		if (lods[lod].error * pixelsPerUnit <= maxPixelError) {
+			return lod;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "ModelData.h"
+#include "engine/math/Matrix.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// LODの1段。頂点は元のModelDataのものをそのまま使い、Indexの範囲だけを持つ
+struct MeshLod {
+	std::vector<SubmeshData> submeshes; // modelData.indicesの範囲
+	float error; // 元の形からのずれ（モデル空間の距離）の上限の目安
+};
+
+// LODの作り方
+struct LodOptions {
+	// 元の三角形数に対する各段の割合。細かい順に並べる
+	std::vector<float> triangleRatios = { 0.5f, 0.25f, 0.125f };
+	// これより誤差が大きくなる縮約はしない（モデル空間の距離）
+	float maxError = std::numeric_limits<float>::max();
+};
+
+// 二次誤差（QEM）で辺を縮約し、三角形数がtargetIndexCount / 3以下になるまで簡略化する
+// 頂点は縮約先の元の頂点をそのまま使うので、頂点配列は変わらずIndexだけが減る
+// UVや法線の継ぎ目の頂点は、継ぎ目に沿った辺でだけ縮約する（両側の頂点をそれぞれの側の縮約先へ付け替える）
+// 法線の向きの差が小さくUVが同じ頂点は継ぎ目とみなさないので、面ごとに頂点の分かれたフラットシェーディングのメッシュも
+// なだらかな所は簡略化できる（縮約後の三角形は隣の面の法線を使うことがある）。角の立った辺は継ぎ目として残る
+// 継ぎ目の線は境界と同じく垂直な平面で形を保つ。戻り値は行った縮約の誤差の最大値
+float SimplifyIndices(std::vector<uint32_t>& destination, std::span<const uint32_t> indices, const std::vector<VertexData>& vertices,
+	size_t targetIndexCount, float maxError = std::numeric_limits<float>::max());
+
+// サブメッシュごとに簡略化してLODを作る。簡略化したIndexはmodelData.indicesの後ろに足す
+// 先頭は元のメッシュ（誤差0）。三角形がほとんど減らなくなったらそこで打ち切る
+std::vector<MeshLod> BuildLodChain(ModelData& modelData, const LodOptions& options = {});
+
+// 画面上での誤差がmaxPixelErrorピクセル以下に収まる、一番粗いLODを選ぶ
+// distanceはカメラからの距離。拡大縮小しているときは拡大率で割ってモデル空間の距離にして渡す
+size_t SelectLod(std::span<const MeshLod> lods, float distance, const Matrix4x4& projection, float viewportHeight, float maxPixelError = 1.0f);
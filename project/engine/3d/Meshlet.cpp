@@ -0,0 +1,144 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+	// 法線の円錐がこれより広がっているとき（cosが小さいとき）は裏向きの判定をしない
+	const float kMinConeCos = 0.1f;
+
+	// メッシュレットの境界球と法線の円錐を求める
+	MeshletBounds ComputeBounds(const MeshletData& meshletData, const Meshlet& meshlet, const ModelData& modelData) {
+		std::vector<Vector3> positions(meshlet.vertexCount);
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+			const Vector4& p = modelData.verticles[meshletData.vertices[meshlet.vertexOffset + i]].position;
+			positions[i] = { p.x, p.y, p.z };
+		}
+
+		MeshletBounds bounds{};
+		bounds.sphere = MakeBoundingSphere(positions);
+
+		// 三角形の法線の平均を円錐の軸にし、一番外れた法線との角度を円錐の広がりにする
+		std::vector<Vector3> normals;
+		normals.reserve(meshlet.triangleCount);
+		Vector3 axis = { 0.0f, 0.0f, 0.0f };
+		for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+			const uint8_t* triangle = &meshletData.triangles[(meshlet.triangleOffset + t) * 3];
+			Vector3 normal = Cross(positions[triangle[1]] - positions[triangle[0]], positions[triangle[2]] - positions[triangle[0]]);
+			const float length = Length(normal);
+			if (length == 0.0f) {
+				continue;
+			}
+			normal = normal / length;
+			normals.push_back(normal);
+			axis = axis + normal;
+		}
+		const float axisLength = Length(axis);
+		if (normals.empty() || axisLength == 0.0f) {
+			bounds.coneAxis = { 0.0f, 0.0f, 1.0f };
+			bounds.coneCutoff = 1.0f;
+			return bounds;
+		}
+		axis = axis / axisLength;
+		float minDot = 1.0f;
+		for (const Vector3& normal : normals) {
+			minDot = std::min(minDot, Dot(axis, normal));
+		}
+		bounds.coneAxis = axis;
+		bounds.coneCutoff = minDot <= kMinConeCos ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+		return bounds;
+	}
+}
+
+MeshletData BuildMeshlets(const ModelData& modelData, std::span<const SubmeshData> submeshes) {
+	assert(!modelData.indices.empty());
+	MeshletData meshletData;
+	// verticlesの番号からメッシュレット内の番号への表。使っていない頂点はkUnused
+	const uint8_t kUnused = 0xff;
+	std::vector<uint8_t> localIndex(modelData.verticles.size(), kUnused);
+
+	for (const SubmeshData& submesh : submeshes) {
+		Meshlet meshlet{};
+		auto finish = [&]() {
+			if (meshlet.triangleCount == 0) {
+				return;
+			}
+			for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+				localIndex[meshletData.vertices[meshlet.vertexOffset + i]] = kUnused;
+			}
+			meshletData.meshlets.push_back(meshlet);
+			meshletData.bounds.push_back(ComputeBounds(meshletData, meshlet, modelData));
+		};
+		auto begin = [&](uint32_t indexOffset) {
+			meshlet.vertexOffset = uint32_t(meshletData.vertices.size());
+			meshlet.vertexCount = 0;
+			meshlet.triangleOffset = uint32_t(meshletData.triangles.size() / 3);
+			meshlet.triangleCount = 0;
+			meshlet.indexOffset = indexOffset;
+			meshlet.materialIndex = submesh.materialIndex;
+		};
+
+		begin(submesh.indexOffset);
+		for (uint32_t i = submesh.indexOffset; i + 2 < submesh.indexOffset + submesh.indexCount; i += 3) {
+			const uint32_t* triangle = &modelData.indices[i];
+			uint32_t newVertexCount = 0;
+			for (int k = 0; k < 3; k++) {
+				if (localIndex[triangle[k]] == kUnused && (k < 1 || triangle[k] != triangle[0]) && (k < 2 || triangle[k] != triangle[1])) {
+					newVertexCount++;
+				}
+			}
+			// 入りきらなければ今のメッシュレットを閉じて次を始める
+			if (meshlet.vertexCount + newVertexCount > kMeshletMaxVertices || meshlet.triangleCount + 1 > kMeshletMaxTriangles) {
+				finish();
+				begin(i);
+			}
+			for (int k = 0; k < 3; k++) {
+				if (localIndex[triangle[k]] == kUnused) {
+					localIndex[triangle[k]] = uint8_t(meshlet.vertexCount++);
+					meshletData.vertices.push_back(triangle[k]);
+				}
+				meshletData.triangles.push_back(localIndex[triangle[k]]);
+			}
+			meshlet.triangleCount++;
+		}
+		finish();
+	}
+	return meshletData;
+}
+
+void CullMeshlets(const MeshletData& meshletData, const Frustum& frustum, const Vector3& cameraPosition, std::span<uint8_t> visible) {
+	assert(visible.size() >= meshletData.meshlets.size());
+	for (size_t i = 0; i < meshletData.meshlets.size(); i++) {
+		if (visible[i]) {
+			continue;
+		}
+		const MeshletBounds& bounds = meshletData.bounds[i];
+		if (!IsVisible(frustum, bounds.sphere)) {
+			continue;
+		}
+		// カメラから球への向きが円錐の軸と十分に揃っていれば、どの三角形も裏を向いている
+		if (bounds.coneCutoff < 1.0f) {
+			const Vector3 toCenter = bounds.sphere.center - cameraPosition;
+			if (Dot(toCenter, bounds.coneAxis) >= bounds.coneCutoff * Length(toCenter) + bounds.sphere.radius) {
+				continue;
+			}
+		}
+		visible[i] = 1;
+	}
+}
+
+void BuildMeshletDrawRanges(const MeshletData& meshletData, std::span<const uint8_t> visible, std::vector<SubmeshData>& outRanges) {
+	outRanges.clear();
+	for (size_t i = 0; i < meshletData.meshlets.size(); i++) {
+		if (!visible[i]) {
+			continue;
+		}
+		const Meshlet& meshlet = meshletData.meshlets[i];
+		if (!outRanges.empty() && outRanges.back().materialIndex == meshlet.materialIndex &&
+			outRanges.back().indexOffset + outRanges.back().indexCount == meshlet.indexOffset) {
+			outRanges.back().indexCount += meshlet.triangleCount * 3;
+		} else {
+			outRanges.push_back({ "", meshlet.indexOffset, meshlet.triangleCount * 3, meshlet.materialIndex });
+		}
+	}
+}
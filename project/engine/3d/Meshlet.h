@@ -0,0 +1,50 @@
+#pragma once
+#include "ModelData.h"
+#include "engine/math/Geometry.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// メッシュレット1つに入れる頂点と三角形の上限。メッシュシェーダーの出力の上限に合わせてある
+const uint32_t kMeshletMaxVertices = 64;
+const uint32_t kMeshletMaxTriangles = 124;
+
+// 三角形の小さなまとまり。三角形はmodelData.indicesの連続した範囲をそのまま使う
+struct Meshlet {
+	uint32_t vertexOffset; // MeshletData::verticesの範囲
+	uint32_t vertexCount;
+	uint32_t triangleOffset; // MeshletData::trianglesの範囲（三角形の番号）
+	uint32_t triangleCount;
+	uint32_t indexOffset; // modelData.indicesでの先頭。Index数はtriangleCount * 3
+	uint32_t materialIndex;
+};
+
+// メッシュレットのカリング用の情報（モデル空間）
+struct MeshletBounds {
+	Sphere sphere;
+	// 法線が収まる円錐。coneCutoffが1なら法線がばらけていて裏向きの判定はできない
+	Vector3 coneAxis;
+	float coneCutoff; // 円錐の半角の正弦
+};
+
+// メッシュのメッシュレット
+struct MeshletData {
+	std::vector<Meshlet> meshlets;
+	std::vector<MeshletBounds> bounds;
+	// メッシュレット内の頂点番号からverticlesの番号への表
+	std::vector<uint32_t> vertices;
+	// 三角形ごとにメッシュレット内の頂点番号を3つ
+	std::vector<uint8_t> triangles;
+};
+
+// サブメッシュごとに、並んでいる三角形を前から順に上限までまとめてメッシュレットにする
+// 三角形の順番は変えないので、先にOptimizeMeshをかけておくとまとまりが良くなる
+MeshletData BuildMeshlets(const ModelData& modelData, std::span<const SubmeshData> submeshes);
+
+// 視錐台の外にあるものと、全ての三角形がカメラに背を向けているものを除く
+// 視錐台とカメラの位置はモデル空間で渡す。見えていればvisibleを1にするだけなので、
+// 0で埋めてからインスタンスごとに呼ぶと、どれかのインスタンスで見えているものが残る
+void CullMeshlets(const MeshletData& meshletData, const Frustum& frustum, const Vector3& cameraPosition, std::span<uint8_t> visible);
+
+// 見えているメッシュレットのIndexの範囲を、隣り合っていてマテリアルが同じものはまとめて描画範囲にする
+void BuildMeshletDrawRanges(const MeshletData& meshletData, std::span<const uint8_t> visible, std::vector<SubmeshData>& outRanges);
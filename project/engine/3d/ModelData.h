@@ -0,0 +1,56 @@
+#pragma once
+#include "engine/math/Geometry.h"
+#include "engine/math/Vector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 頂点データ
+struct VertexData {
+	Vector4 position;
+	Vector2 texcoord;
+	Vector3 normal;
+};
+
+// マテリアルデータ
+struct MaterialData {
+	std::string name; // mtlのnewmtlの名前
+	std::string textureFilePath;
+};
+
+// 境界（モデル空間）
+struct MeshBounds {
+	AABB aabb;
+	Sphere sphere;
+};
+
+// サブメッシュ。同じマテリアルで描く三角形の範囲
+struct SubmeshData {
+	std::string name; // objのo/gの名前
+	// indicesの範囲。indicesが空ならverticlesの範囲
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	uint32_t materialIndex; // materialsの番号
+	MeshBounds bounds = {}; // 範囲の三角形の頂点を囲む境界
+};
+
+// モデルデータ
+struct ModelData {
+	std::vector<VertexData> verticles;
+	// 頂点ごとの接線。空なら接線なし。wは従法線の向き（±1）
+	std::vector<Vector4> tangents;
+	// 三角形リストのIndex。空ならverticlesを3つずつ三角形として描く
+	std::vector<uint32_t> indices;
+	// 先頭のサブメッシュのマテリアル
+	MaterialData material;
+	std::vector<MaterialData> materials;
+	// テクスチャが同じものが並ぶように整列してある
+	std::vector<SubmeshData> submeshes;
+	// すべての頂点を囲む境界
+	MeshBounds bounds = {};
+};
+
+// Indexを16bitで表せるか
+inline bool CanUse16BitIndices(const ModelData& modelData) {
+	return modelData.verticles.size() <= 0x10000;
+}
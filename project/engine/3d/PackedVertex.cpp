@@ -0,0 +1,137 @@
+#include "PackedVertex.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace {
+	// [0,1]を16bitの符号なし正規化整数へ
+	uint16_t ToUnorm16(float value) {
+		return uint16_t(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	// [-1,1]を16bitの符号付き正規化整数へ
+	int16_t ToSnorm16(float value) {
+		return int16_t(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	// GPUと同じく-32768は-1として扱う
+	float FromSnorm16(int16_t value) {
+		return std::max(float(value) / 32767.0f, -1.0f);
+	}
+
+	float SignNotZero(float value) {
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+}
+
+VertexQuantization MakeVertexQuantization(const AABB& aabb) {
+	VertexQuantization quantization = {};
+	quantization.offset = aabb.min;
+	quantization.scale = aabb.max - aabb.min;
+	return quantization;
+}
+
+uint16_t FloatToHalf(float value) {
+	const uint32_t bits = std::bit_cast<uint32_t>(value);
+	const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+	const uint32_t absolute = bits & 0x7fffffff;
+
+	// NaNと無限大
+	if (absolute >= 0x7f800000) {
+		return uint16_t(sign | 0x7c00 | (absolute > 0x7f800000 ? 0x0200 : 0));
+	}
+	// 半精度で表せないほど大きい値は無限大
+	if (absolute >= 0x477ff000) {
+		return uint16_t(sign | 0x7c00);
+	}
+	// 非正規化数になる小さい値。仮数を右にずらして偶数へ丸める
+	if (absolute < 0x38800000) {
+		const uint32_t shift = 126 - (absolute >> 23);
+		if (shift > 25) {
+			return sign;
+		}
+		const uint32_t mantissa = (absolute & 0x007fffff) | 0x00800000;
+		const uint32_t half = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		return uint16_t(sign | (half + (remainder > halfway || (remainder == halfway && (half & 1)) ? 1 : 0)));
+	}
+	// 正規化数。指数の差を付け替え、下位13bitを偶数へ丸める（繰り上がりは指数へそのまま伝わる）
+	const uint32_t rebased = absolute - 0x38000000;
+	return uint16_t(sign | ((rebased + 0x0fff + ((rebased >> 13) & 1)) >> 13));
+}
+
+float HalfToFloat(uint16_t value) {
+	const uint32_t sign = uint32_t(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1f;
+	const uint32_t mantissa = value & 0x03ff;
+	if (exponent == 0) {
+		// 0と非正規化数
+		const float magnitude = std::ldexp(float(mantissa), -24);
+		return sign ? -magnitude : magnitude;
+	}
+	if (exponent == 0x1f) {
+		return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+	}
+	return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+Vector2 EncodeOctahedral(const Vector3& normal) {
+	const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (sum == 0.0f) {
+		return { 0.0f, 0.0f };
+	}
+	Vector2 encoded = { normal.x / sum, normal.y / sum };
+	// 下半分は四隅へ折り返す
+	if (normal.z < 0.0f) {
+		encoded = { (1.0f - std::abs(encoded.y)) * SignNotZero(encoded.x), (1.0f - std::abs(encoded.x)) * SignNotZero(encoded.y) };
+	}
+	return encoded;
+}
+
+Vector3 DecodeOctahedral(const Vector2& encoded) {
+	Vector3 normal = { encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+	if (normal.z < 0.0f) {
+		normal.x = (1.0f - std::abs(encoded.y)) * SignNotZero(encoded.x);
+		normal.y = (1.0f - std::abs(encoded.x)) * SignNotZero(encoded.y);
+	}
+	return Normalize(normal);
+}
+
+PackedVertexData PackVertex(const VertexData& vertex, const VertexQuantization& quantization) {
+	PackedVertexData packed = {};
+	const float position[3] = { vertex.position.x, vertex.position.y, vertex.position.z };
+	const float offset[3] = { quantization.offset.x, quantization.offset.y, quantization.offset.z };
+	const float scale[3] = { quantization.scale.x, quantization.scale.y, quantization.scale.z };
+	for (int axis = 0; axis < 3; axis++) {
+		// 厚みのない軸はすべて0にする
+		packed.position[axis] = scale[axis] != 0.0f ? ToUnorm16((position[axis] - offset[axis]) / scale[axis]) : 0;
+	}
+	const Vector2 normal = EncodeOctahedral(vertex.normal);
+	packed.normal[0] = ToSnorm16(normal.x);
+	packed.normal[1] = ToSnorm16(normal.y);
+	packed.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+	packed.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+	return packed;
+}
+
+VertexData UnpackVertex(const PackedVertexData& vertex, const VertexQuantization& quantization) {
+	VertexData unpacked = {};
+	unpacked.position = {
+		float(vertex.position[0]) / 65535.0f * quantization.scale.x + quantization.offset.x,
+		float(vertex.position[1]) / 65535.0f * quantization.scale.y + quantization.offset.y,
+		float(vertex.position[2]) / 65535.0f * quantization.scale.z + quantization.offset.z,
+		1.0f,
+	};
+	unpacked.texcoord = { HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]) };
+	unpacked.normal = DecodeOctahedral({ FromSnorm16(vertex.normal[0]), FromSnorm16(vertex.normal[1]) });
+	return unpacked;
+}
+
+std::vector<PackedVertexData> PackVertices(std::span<const VertexData> vertices, const VertexQuantization& quantization) {
+	std::vector<PackedVertexData> packed(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		packed[i] = PackVertex(vertices[i], quantization);
+	}
+	return packed;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "ModelData.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// GPUへ送る圧縮した頂点（16バイト）。VertexData（40バイト）の代わりに頂点バッファへ入れる
+struct PackedVertexData {
+	uint16_t position[4]; // メッシュの境界箱の中の位置を16bitに量子化したもの（R16G16B16A16_UNORM）。wは使わない
+	int16_t normal[2]; // 八面体に展開した法線（R16G16_SNORM）
+	uint16_t texcoord[2]; // 半精度浮動小数点数（R16G16_FLOAT）
+};
+static_assert(sizeof(PackedVertexData) == 16);
+
+// 量子化した位置をモデル空間へ戻す係数。position = quantized * scale + offset
+// シェーダーの定数バッファと同じ並びにしてある
+struct VertexQuantization {
+	Vector3 offset;
+	float padding0;
+	Vector3 scale;
+	float padding1;
+};
+
+// 頂点の境界箱（ModelData::bounds.aabb）から量子化の係数を作る
+VertexQuantization MakeVertexQuantization(const AABB& aabb);
+
+// 半精度浮動小数点数との変換。最も近い値へ丸める
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// 単位ベクトルを八面体に展開して[-1,1]の2次元にする。逆変換の結果は正規化してある
+Vector2 EncodeOctahedral(const Vector3& normal);
+Vector3 DecodeOctahedral(const Vector2& encoded);
+
+// 頂点の圧縮と展開
+PackedVertexData PackVertex(const VertexData& vertex, const VertexQuantization& quantization);
+VertexData UnpackVertex(const PackedVertexData& vertex, const VertexQuantization& quantization);
+std::vector<PackedVertexData> PackVertices(std::span<const VertexData> vertices, const VertexQuantization& quantization);
@@ -0,0 +1,248 @@
+#include "TangentSpace.h"
+#include "engine/math/Vector3A.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+	// 1スレッドに任せる最小の要素数。これより小さいメッシュは分けずに処理する
+	const size_t kMinItemsPerThread = 16384;
+
+	// [0, count)をおよそ等分し、func(begin, end)をそれぞれ別のスレッドで実行する
+	template <typename Func>
+	void ParallelForRanges(size_t count, uint32_t numThreads, Func&& func) {
+		if (numThreads == 0) {
+			numThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		const size_t numRanges = std::max<size_t>(1, std::min<size_t>(numThreads, count / kMinItemsPerThread));
+		std::vector<std::thread> threads;
+		threads.reserve(numRanges - 1);
+		for (size_t i = 1; i < numRanges; i++) {
+			threads.emplace_back([&func, i, count, numRanges]() { func(count * i / numRanges, count * (i + 1) / numRanges); });
+		}
+		func(0, count / numRanges);
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	Vector3A GetPosition(const VertexData& vertex) {
+		return Vector3A(vertex.position.x, vertex.position.y, vertex.position.z);
+	}
+
+	// 2辺の間の角度
+	float CornerAngle(const Vector3A& edge1, const Vector3A& edge2) {
+		const float lengths = Length(edge1) * Length(edge2);
+		if (lengths == 0.0f) {
+			return 0.0f;
+		}
+		return std::acos(std::clamp(Dot(edge1, edge2) / lengths, -1.0f, 1.0f));
+	}
+
+	// 三角形の角（indicesの各要素）。indicesが空ならverticlesを3つずつ三角形とみなす
+	class Corners {
+	public:
+		explicit Corners(const ModelData& modelData)
+			: indices_(modelData.indices), count_(modelData.indices.empty() ? modelData.verticles.size() / 3 * 3 : modelData.indices.size()) {}
+
+		size_t GetCount() const { return count_; }
+		uint32_t GetVertex(size_t corner) const { return indices_.empty() ? uint32_t(corner) : indices_[corner]; }
+
+	private:
+		const std::vector<uint32_t>& indices_;
+		size_t count_;
+	};
+
+	// キーのビット列が同じ頂点に同じグループ番号を振り、グループごとに角の一覧を作る
+	// 角は番号順に並ぶので、グループごとの和はスレッド数によらず同じになる
+	struct CornerGroups {
+		std::vector<uint32_t> groupOf; // 頂点からグループ
+		std::vector<uint32_t> cornerStarts; // グループごとのcornersの範囲
+		std::vector<uint32_t> corners;
+	};
+
+	template <size_t N, typename KeyFunc>
+	CornerGroups GroupCorners(const Corners& corners, size_t vertexCount, KeyFunc&& makeKey) {
+		struct Key {
+			std::array<uint32_t, N> bits;
+			uint32_t vertex;
+		};
+		std::vector<Key> keys(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+			keys[vertex].bits = makeKey(vertex);
+			keys[vertex].vertex = vertex;
+		}
+		std::sort(keys.begin(), keys.end(), [](const Key& a, const Key& b) {
+			return a.bits != b.bits ? a.bits < b.bits : a.vertex < b.vertex;
+		});
+
+		CornerGroups groups;
+		groups.groupOf.resize(vertexCount);
+		uint32_t groupCount = 0;
+		for (size_t i = 0; i < keys.size(); i++) {
+			if (i != 0 && keys[i - 1].bits != keys[i].bits) {
+				groupCount++;
+			}
+			groups.groupOf[keys[i].vertex] = groupCount;
+		}
+		groupCount += keys.empty() ? 0 : 1;
+
+		// 数えてから累積和の位置へ並べる
+		groups.cornerStarts.assign(groupCount + 1, 0);
+		for (size_t corner = 0; corner < corners.GetCount(); corner++) {
+			groups.cornerStarts[groups.groupOf[corners.GetVertex(corner)] + 1]++;
+		}
+		for (uint32_t group = 0; group < groupCount; group++) {
+			groups.cornerStarts[group + 1] += groups.cornerStarts[group];
+		}
+		groups.corners.resize(corners.GetCount());
+		std::vector<uint32_t> cursors(groups.cornerStarts.begin(), groups.cornerStarts.end() - 1);
+		for (size_t corner = 0; corner < corners.GetCount(); corner++) {
+			groups.corners[cursors[groups.groupOf[corners.GetVertex(corner)]]++] = uint32_t(corner);
+		}
+		return groups;
+	}
+
+	// 浮動小数点数のビット列をキーにする。-0と0は同じにする
+	uint32_t ToKeyBits(float value) {
+		uint32_t bits;
+		value += 0.0f;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// 法線に直交する適当な単位ベクトル
+	Vector3A MakePerpendicular(const Vector3A& normal) {
+		const Vector3A axis = std::abs(normal.x) < 0.9f ? Vector3A(1.0f, 0.0f, 0.0f) : Vector3A(0.0f, 1.0f, 0.0f);
+		return Normalize(Cross(normal, axis));
+	}
+}
+
+void GenerateNormals(ModelData& modelData, uint32_t numThreads, std::span<const uint8_t> targets) {
+	std::vector<VertexData>& vertices = modelData.verticles;
+	const Corners corners(modelData);
+	const size_t triangleCount = corners.GetCount() / 3;
+
+	// 角ごとに、面の法線に内角を掛けたものを求める
+	std::vector<Vector3A> contributions(corners.GetCount());
+	ParallelForRanges(triangleCount, numThreads, [&](size_t begin, size_t end) {
+		for (size_t triangle = begin; triangle < end; triangle++) {
+			const Vector3A p[3] = {
+				GetPosition(vertices[corners.GetVertex(triangle * 3 + 0)]),
+				GetPosition(vertices[corners.GetVertex(triangle * 3 + 1)]),
+				GetPosition(vertices[corners.GetVertex(triangle * 3 + 2)]),
+			};
+			const Vector3A normal = Normalize(Cross(p[1] - p[0], p[2] - p[0]));
+			for (int k = 0; k < 3; k++) {
+				contributions[triangle * 3 + k] = normal * CornerAngle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+			}
+		}
+	});
+
+	// 同じ位置の頂点の角をまとめて足す
+	const CornerGroups groups = GroupCorners<3>(corners, vertices.size(), [&](uint32_t vertex) {
+		const Vector4& position = vertices[vertex].position;
+		return std::array<uint32_t, 3>{ ToKeyBits(position.x), ToKeyBits(position.y), ToKeyBits(position.z) };
+	});
+	const size_t groupCount = groups.cornerStarts.size() - 1;
+	std::vector<Vector3A> normals(groupCount);
+	ParallelForRanges(groupCount, numThreads, [&](size_t begin, size_t end) {
+		for (size_t group = begin; group < end; group++) {
+			Vector3A sum(0.0f, 0.0f, 0.0f);
+			for (uint32_t i = groups.cornerStarts[group]; i < groups.cornerStarts[group + 1]; i++) {
+				sum += contributions[groups.corners[i]];
+			}
+			normals[group] = Normalize(sum);
+		}
+	});
+
+	// 面に使われていない頂点と対象外の頂点は元の法線のままにする
+	assert(targets.empty() || targets.size() == vertices.size());
+	ParallelForRanges(vertices.size(), numThreads, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			if (!targets.empty() && targets[vertex] == 0) {
+				continue;
+			}
+			const Vector3A& normal = normals[groups.groupOf[vertex]];
+			if (Dot(normal, normal) != 0.0f) {
+				vertices[vertex].normal = normal.ToVector3();
+			}
+		}
+	});
+}
+
+void GenerateTangents(ModelData& modelData, uint32_t numThreads) {
+	const std::vector<VertexData>& vertices = modelData.verticles;
+	const Corners corners(modelData);
+	const size_t triangleCount = corners.GetCount() / 3;
+
+	// 角ごとに、面のUVのu方向とv方向を頂点の法線に直交させ、内角を掛けたものを求める
+	std::vector<Vector3A> tangentContributions(corners.GetCount());
+	std::vector<Vector3A> bitangentContributions(corners.GetCount());
+	ParallelForRanges(triangleCount, numThreads, [&](size_t begin, size_t end) {
+		for (size_t triangle = begin; triangle < end; triangle++) {
+			const VertexData* v[3] = {
+				&vertices[corners.GetVertex(triangle * 3 + 0)],
+				&vertices[corners.GetVertex(triangle * 3 + 1)],
+				&vertices[corners.GetVertex(triangle * 3 + 2)],
+			};
+			const Vector3A p[3] = { GetPosition(*v[0]), GetPosition(*v[1]), GetPosition(*v[2]) };
+			const Vector3A edge1 = p[1] - p[0];
+			const Vector3A edge2 = p[2] - p[0];
+			const float du1 = v[1]->texcoord.x - v[0]->texcoord.x, dv1 = v[1]->texcoord.y - v[0]->texcoord.y;
+			const float du2 = v[2]->texcoord.x - v[0]->texcoord.x, dv2 = v[2]->texcoord.y - v[0]->texcoord.y;
+			const float determinant = du1 * dv2 - du2 * dv1;
+			// UVが潰れている面は接線を決められないので寄与させない
+			Vector3A faceTangent(0.0f, 0.0f, 0.0f), faceBitangent(0.0f, 0.0f, 0.0f);
+			if (determinant != 0.0f) {
+				faceTangent = Normalize((edge1 * dv2 - edge2 * dv1) / determinant);
+				faceBitangent = Normalize((edge2 * du1 - edge1 * du2) / determinant);
+			}
+			for (int k = 0; k < 3; k++) {
+				const Vector3A normal(v[k]->normal);
+				const float angle = CornerAngle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+				tangentContributions[triangle * 3 + k] = Normalize(faceTangent - normal * Dot(normal, faceTangent)) * angle;
+				bitangentContributions[triangle * 3 + k] = Normalize(faceBitangent - normal * Dot(normal, faceBitangent)) * angle;
+			}
+		}
+	});
+
+	// 位置・法線・UVが同じ頂点の角をまとめて足す
+	const CornerGroups groups = GroupCorners<8>(corners, vertices.size(), [&](uint32_t vertex) {
+		const VertexData& v = vertices[vertex];
+		return std::array<uint32_t, 8>{ ToKeyBits(v.position.x), ToKeyBits(v.position.y), ToKeyBits(v.position.z),
+			ToKeyBits(v.normal.x), ToKeyBits(v.normal.y), ToKeyBits(v.normal.z), ToKeyBits(v.texcoord.x), ToKeyBits(v.texcoord.y) };
+	});
+	const size_t groupCount = groups.cornerStarts.size() - 1;
+	std::vector<Vector3A> tangentSums(groupCount), bitangentSums(groupCount);
+	ParallelForRanges(groupCount, numThreads, [&](size_t begin, size_t end) {
+		for (size_t group = begin; group < end; group++) {
+			Vector3A tangent(0.0f, 0.0f, 0.0f), bitangent(0.0f, 0.0f, 0.0f);
+			for (uint32_t i = groups.cornerStarts[group]; i < groups.cornerStarts[group + 1]; i++) {
+				tangent += tangentContributions[groups.corners[i]];
+				bitangent += bitangentContributions[groups.corners[i]];
+			}
+			tangentSums[group] = tangent;
+			bitangentSums[group] = bitangent;
+		}
+	});
+
+	// 法線に直交させ、従法線がどちら向きかをwに入れる
+	modelData.tangents.resize(vertices.size());
+	ParallelForRanges(vertices.size(), numThreads, [&](size_t begin, size_t end) {
+		for (size_t vertex = begin; vertex < end; vertex++) {
+			const Vector3A normal(vertices[vertex].normal);
+			const Vector3A& sum = tangentSums[groups.groupOf[vertex]];
+			Vector3A tangent = Normalize(sum - normal * Dot(normal, sum));
+			if (Dot(tangent, tangent) == 0.0f) {
+				tangent = MakePerpendicular(normal);
+			}
+			const float handedness = Dot(Cross(normal, tangent), bitangentSums[groups.groupOf[vertex]]) < 0.0f ? -1.0f : 1.0f;
+			modelData.tangents[vertex] = { tangent.x, tangent.y, tangent.z, handedness };
+		}
+	});
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "ModelData.h"
+#include <cstdint>
+#include <span>
+
+// 同じ位置の頂点を1つの点とみなし、周りの面の法線を角の内角で重み付けして平均した法線を入れる
+// UVの継ぎ目で分かれている頂点も同じ法線になるので、継ぎ目に段差ができない
+// numThreadsが0ならハードウェアのスレッド数。小さなメッシュは1スレッドで処理する
+// targetsを渡したときは、0でない要素の頂点だけ法線を書き換える（ほかの頂点の法線はそのまま残し、平均には面として加える）
+void GenerateNormals(ModelData& modelData, uint32_t numThreads = 0, std::span<const uint8_t> targets = {});
+
+// UVの向きから接線を作り、modelData.tangentsに入れる（MikkTSpaceと同じ考え方）
+// 位置・法線・UVがすべて同じ頂点をまとめ、面の接線を内角で重み付けして平均し、法線に直交させる
+// 従法線は Cross(normal, tangent.xyz) * tangent.w。UVのない面は接線を決められないので適当な直交ベクトルになる
+void GenerateTangents(ModelData& modelData, uint32_t numThreads = 0);
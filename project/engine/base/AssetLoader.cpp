@@ -0,0 +1,106 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <cassert>
+
+AssetLoader::AssetLoader(uint32_t numThreads, std::function<void()> onThreadStart, std::function<void()> onThreadExit)
+	: onThreadStart_(std::move(onThreadStart)), onThreadExit_(std::move(onThreadExit)) {
+	if (numThreads == 0) {
+		// hardware_concurrencyは分からなければ0を返すので、引く前に2以上にしておく
+		numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+	threads_.reserve(numThreads);
+	for (uint32_t i = 0; i < numThreads; i++) {
+		threads_.emplace_back([this]() { WorkerMain(); });
+	}
+}
+
+AssetLoader::~AssetLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		isStopping_ = true;
+		requests_.clear();
+	}
+	condition_.notify_all();
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+	// 完了時の関数を呼ばずに、読み込んだものを破棄時の関数に渡して捨てる
+	Job* job = completed_.exchange(nullptr, std::memory_order_acquire);
+	while (job) {
+		Job* next = job->next;
+		job->Discard();
+		delete job;
+		job = next;
+	}
+}
+
+size_t AssetLoader::Update() {
+	// まとめて取り出すと後に終わったものが先頭にあるので、逆順にして終わった順へ戻す
+	Job* job = completed_.exchange(nullptr, std::memory_order_acquire);
+	Job* ordered = nullptr;
+	while (job) {
+		Job* next = job->next;
+		job->next = ordered;
+		ordered = job;
+		job = next;
+	}
+
+	size_t count = 0;
+	while (ordered) {
+		std::unique_ptr<Job> current(ordered);
+		ordered = ordered->next;
+		assert(pendingCount_ > 0);
+		pendingCount_--;
+		current->Complete();
+		count++;
+	}
+	return count;
+}
+
+void AssetLoader::WaitAll() {
+	while (pendingCount_ > 0) {
+		if (Update() == 0) {
+			completed_.wait(nullptr, std::memory_order_acquire);
+		}
+	}
+}
+
+void AssetLoader::Enqueue(std::unique_ptr<Job> job) {
+	pendingCount_++;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		requests_.push_back(std::move(job));
+	}
+	condition_.notify_one();
+}
+
+void AssetLoader::WorkerMain() {
+	if (onThreadStart_) {
+		onThreadStart_();
+	}
+	for (;;) {
+		std::unique_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return isStopping_ || !requests_.empty(); });
+			if (isStopping_) {
+				break;
+			}
+			job = std::move(requests_.front());
+			requests_.pop_front();
+		}
+		job->Load();
+		PushCompleted(job.release());
+	}
+	if (onThreadExit_) {
+		onThreadExit_();
+	}
+}
+
+void AssetLoader::PushCompleted(Job* job) {
+	Job* head = completed_.load(std::memory_order_relaxed);
+	do {
+		job->next = head;
+	} while (!completed_.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+	completed_.notify_one();
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// アセットを別スレッドで読み込むサービス
+// Requestで積んだ読み込み関数をワーカースレッドで並列に実行し、終わったものはUpdateを呼んだスレッドで完了時の関数に渡す
+// ワーカーではファイルの読み込みやデコードのように、GPUやメインスレッドの状態に触れない処理だけを行うこと
+class AssetLoader {
+public:
+	// numThreadsが0ならハードウェアのスレッド数より1つ少ない数（最低1）
+	// onThreadStartとonThreadExitはワーカースレッドの開始時と終了時にそのスレッドで呼ばれる（COMの初期化など）
+	explicit AssetLoader(uint32_t numThreads = 0, std::function<void()> onThreadStart = nullptr, std::function<void()> onThreadExit = nullptr);
+	// 始まっていない読み込みは捨て、実行中のものが終わるのを待つ
+	// 完了時の関数は呼ばず、終わっていた読み込みの戻り値は破棄時の関数に渡す
+	~AssetLoader();
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	// load()をワーカースレッドで実行し、その戻り値をUpdateでonLoadedに渡す
+	// onLoadedを呼ぶ前にローダーが破棄されたときは、戻り値をonDiscardedに渡す（デストラクタで解放されない資源を返すときに使う）
+	// onDiscardedはローダーのデストラクタから呼ばれるので、先に破棄されるものを参照しないこと
+	template <typename LoadFunc, typename OnLoadedFunc, typename OnDiscardedFunc>
+	void Request(LoadFunc&& load, OnLoadedFunc&& onLoaded, OnDiscardedFunc&& onDiscarded) {
+		using Result = std::invoke_result_t<std::decay_t<LoadFunc>&>;
+		Enqueue(std::make_unique<TypedJob<std::decay_t<LoadFunc>, std::decay_t<OnLoadedFunc>, std::decay_t<OnDiscardedFunc>, Result>>(
+			std::forward<LoadFunc>(load), std::forward<OnLoadedFunc>(onLoaded), std::forward<OnDiscardedFunc>(onDiscarded)));
+	}
+	// 破棄時は戻り値のデストラクタに任せる
+	template <typename LoadFunc, typename OnLoadedFunc>
+	void Request(LoadFunc&& load, OnLoadedFunc&& onLoaded) {
+		using Result = std::invoke_result_t<std::decay_t<LoadFunc>&>;
+		Request(std::forward<LoadFunc>(load), std::forward<OnLoadedFunc>(onLoaded), [](Result&&) {});
+	}
+
+	// 終わった読み込みの完了時の関数を、終わった順に呼ぶ。呼んだ数を返す
+	size_t Update();
+	// すべての読み込みが終わるまで待ち、完了時の関数を呼ぶ
+	void WaitAll();
+	// 完了時の関数がまだ呼ばれていない読み込みの数
+	size_t GetPendingCount() const { return pendingCount_; }
+	// ワーカースレッドの数
+	uint32_t GetThreadCount() const { return uint32_t(threads_.size()); }
+
+private:
+	// 読み込み1つ分
+	struct Job {
+		virtual ~Job() = default;
+		virtual void Load() = 0; // ワーカースレッドで呼ぶ
+		virtual void Complete() = 0; // Updateを呼んだスレッドで呼ぶ
+		virtual void Discard() = 0; // 読み込みが終わった後、Completeを呼ばずに捨てるときに呼ぶ
+		Job* next = nullptr; // 完了キューでの次
+	};
+
+	template <typename LoadFunc, typename OnLoadedFunc, typename OnDiscardedFunc, typename Result>
+	struct TypedJob : Job {
+		template <typename L, typename O, typename D>
+		TypedJob(L&& load, O&& onLoaded, D&& onDiscarded)
+			: load(std::forward<L>(load)), onLoaded(std::forward<O>(onLoaded)), onDiscarded(std::forward<D>(onDiscarded)) {}
+		void Load() override { result.emplace(load()); }
+		void Complete() override { onLoaded(std::move(*result)); }
+		void Discard() override { onDiscarded(std::move(*result)); }
+
+		LoadFunc load;
+		OnLoadedFunc onLoaded;
+		OnDiscardedFunc onDiscarded;
+		std::optional<Result> result;
+	};
+
+	void Enqueue(std::unique_ptr<Job> job);
+	void WorkerMain();
+	// 完了キューに積む（ワーカースレッドから同時に呼ばれる）
+	void PushCompleted(Job* job);
+
+	std::vector<std::thread> threads_;
+	std::function<void()> onThreadStart_;
+	std::function<void()> onThreadExit_;
+
+	// まだ始まっていない読み込み
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::unique_ptr<Job>> requests_;
+	bool isStopping_ = false;
+
+	// 終わった読み込み。ワーカーがロックを取らずに先頭へ積み、Updateがまとめて取り出して順番を戻す
+	std::atomic<Job*> completed_ = nullptr;
+	// Updateを呼ぶスレッドだけが触る
+	size_t pendingCount_ = 0;
+};
@@ -0,0 +1,36 @@
+#include "AssetRegistry.h"
+#include "engine/io/MappedFile.h"
+#include <cctype>
+#include <filesystem>
+
+std::string NormalizeAssetPath(const std::string& path) {
+	std::error_code error;
+	std::filesystem::path absolutePath = std::filesystem::absolute(std::filesystem::path(path), error);
+	if (error) {
+		absolutePath = path;
+	}
+	std::string normalized = absolutePath.lexically_normal().generic_string();
+#ifdef _WIN32
+	// Windowsのファイル名は大文字と小文字を区別しない
+	for (char& c : normalized) {
+		c = char(std::tolower(static_cast<unsigned char>(c)));
+	}
+#endif
+	return normalized;
+}
+
+AssetContentKey GetContentKey(std::string_view contents) {
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c : contents) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+	}
+	return { hash, uint64_t(contents.size()) };
+}
+
+bool FileContentsEqual(const std::string& path, std::string_view contents) {
+	MappedFile file;
+	if (!file.Open(path)) {
+		return false;
+	}
+	return file.GetView() == contents;
+}
@@ -0,0 +1,329 @@
+#pragma once
+#include "AssetLoader.h"
+#include "engine/io/MappedFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 同じファイルを指すパスが同じ文字列になるようにする（絶対パスにして.や..を畳み、区切りを/にそろえる。Windowsでは小文字にする）
+std::string NormalizeAssetPath(const std::string& path);
+
+// ファイルの中身を比べるためのキー。ハッシュ（64bitのFNV-1a）とサイズが同じでも中身が同じとは限らない
+struct AssetContentKey {
+	uint64_t hash;
+	uint64_t size;
+	bool operator==(const AssetContentKey&) const = default;
+};
+struct AssetContentKeyHash {
+	size_t operator()(const AssetContentKey& key) const { return size_t(key.hash ^ (key.size * 0x9E3779B97F4A7C15ull)); }
+};
+// 読み込んだファイルの中身のキーを求める
+AssetContentKey GetContentKey(std::string_view contents);
+// pathのファイルの中身がcontentsと1バイトずつ同じか。開けなければfalse
+bool FileContentsEqual(const std::string& path, std::string_view contents);
+
+// 読み込んだアセットを正規化したパスと中身で共有するレジストリ
+// 同じパス、または別のパスでも中身が同じファイルは1度だけ読み込み、同じハンドルを返す
+// 中身はハッシュとサイズで候補を絞り、最後にバイト列を比べて確かめる
+// ハンドルはshared_ptrで、レジストリの外で持たれている数が参照数になる
+// 参照されていないアセットは残しておき、使用量が予算を超えたときに使われていない順に捨てる
+// メインスレッドだけで使うこと（読み込み自体はLoadAsyncでAssetLoaderのワーカーに任せられる）
+template <typename T>
+class AssetRegistry {
+public:
+	using Handle = std::shared_ptr<T>;
+
+	// getMemorySizeはアセット1つが使うメモリの量を返す。memoryBudgetはその合計の上限
+	// releaseはアセットを捨てるとき（最後のハンドルがなくなったとき）に呼ばれる。デストラクタで解放しない型に使う
+	explicit AssetRegistry(std::function<size_t(const T&)> getMemorySize, size_t memoryBudget = SIZE_MAX, std::function<void(T&)> release = nullptr)
+		: getMemorySize_(std::move(getMemorySize)), release_(std::move(release)), memoryBudget_(memoryBudget) {}
+	AssetRegistry(const AssetRegistry&) = delete;
+	AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+	// 読み込み済みならそれを返す。なければnullptr
+	Handle Find(const std::string& path) { return FindNormalized(NormalizeAssetPath(path)); }
+
+	// ファイルをマップしてload(path, 中身)で読み込む。同じパスか同じ中身のものが登録済みならloadは呼ばない
+	template <typename LoadFunc>
+	Handle Load(const std::string& path, LoadFunc&& load) {
+		const std::string normalizedPath = NormalizeAssetPath(path);
+		if (Handle asset = FindNormalized(normalizedPath)) {
+			return asset;
+		}
+		MappedFile file;
+		const bool isOpen = file.Open(normalizedPath);
+		assert(isOpen);
+		const AssetContentKey contentKey = GetContentKey(file.GetView());
+		if (Handle asset = FindContent(normalizedPath, contentKey, file.GetView())) {
+			return asset;
+		}
+		return Insert(normalizedPath, contentKey, load(normalizedPath, file.GetView()));
+	}
+
+	// ワーカースレッドでファイルをマップし、中身のキーを求めてload(path, 中身)を呼ぶ。loaderのUpdateでcreate(戻り値)からアセットを作る
+	// 終わったらonLoaded(ハンドル)を呼ぶ。登録済みならその場で呼ぶ
+	// 読み込み中の同じパスへの要求は読み込みを待ち、同じハンドルを受け取る
+	// 要求した時点で中身のキーが同じものが登録されていれば、ワーカーでバイト列を比べ、同じならloadを呼ばずにそれを共有する
+	// 別のパスで中身が同じものを同時に読み込んだときは、メインスレッドでファイルを比べないように別のアセットとして登録する
+	// GPUへの転送のようにメインスレッドでしかできない処理はcreateで行う
+	// 捨てる読み込み結果（createに渡さなかったloadの戻り値）はdiscard(戻り値)に渡す。loaderの破棄で捨てるときも同じ
+	// discardはloaderのデストラクタからも呼ばれるので、レジストリやほかの先に破棄されるものを参照しないこと
+	template <typename LoadFunc, typename CreateFunc, typename OnLoadedFunc, typename DiscardFunc>
+	void LoadAsync(AssetLoader& loader, const std::string& path, LoadFunc&& load, CreateFunc&& create, OnLoadedFunc&& onLoaded, DiscardFunc&& discard) {
+		const std::string normalizedPath = NormalizeAssetPath(path);
+		if (Handle asset = FindNormalized(normalizedPath)) {
+			onLoaded(asset);
+			return;
+		}
+		auto [pendingIt, isNew] = pending_.try_emplace(normalizedPath);
+		pendingIt->second.emplace_back(std::forward<OnLoadedFunc>(onLoaded));
+		if (!isNew) {
+			return;
+		}
+
+		using Functions = AsyncFunctions<std::decay_t<LoadFunc>, std::decay_t<CreateFunc>, std::decay_t<DiscardFunc>>;
+		std::shared_ptr<Functions> functions(new Functions{ std::forward<LoadFunc>(load), std::forward<CreateFunc>(create), std::forward<DiscardFunc>(discard) });
+		RequestLoad(loader, normalizedPath, std::move(functions), GetContentSnapshot());
+	}
+	// 読み込み結果をデストラクタだけで解放できる型なら、discardは省ける
+	template <typename LoadFunc, typename CreateFunc, typename OnLoadedFunc>
+	void LoadAsync(AssetLoader& loader, const std::string& path, LoadFunc&& load, CreateFunc&& create, OnLoadedFunc&& onLoaded) {
+		LoadAsync(loader, path, std::forward<LoadFunc>(load), std::forward<CreateFunc>(create), std::forward<OnLoadedFunc>(onLoaded), [](auto&) {});
+	}
+
+	// レジストリの外で持たれている数。登録されていなければ0
+	size_t GetReferenceCount(const std::string& path) const {
+		const auto pathIt = paths_.find(NormalizeAssetPath(path));
+		if (pathIt == paths_.end()) {
+			return 0;
+		}
+		return size_t(entries_.at(pathIt->second).asset.use_count() - 1);
+	}
+
+	// 登録されているアセットの数と、それらが使うメモリの合計
+	size_t GetCount() const { return entries_.size(); }
+	size_t GetMemoryUsage() const { return memoryUsage_; }
+
+	size_t GetMemoryBudget() const { return memoryBudget_; }
+	// 予算を変え、超えていれば参照されていないものを捨てる
+	void SetMemoryBudget(size_t memoryBudget) {
+		memoryBudget_ = memoryBudget;
+		Trim();
+	}
+
+	// 使用量が予算を超えている間、参照されていないアセットを使われていない順に捨てる
+	// ハンドルを手放しただけでは捨てないので、区切りのよいところで呼ぶ
+	void Trim() {
+		if (memoryUsage_ <= memoryBudget_) {
+			return;
+		}
+		std::vector<std::pair<uint64_t, uint64_t>> candidates; // lastUseとエントリーの番号
+		for (const auto& [id, entry] : entries_) {
+			if (entry.asset.use_count() == 1) {
+				candidates.emplace_back(entry.lastUse, id);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+		for (const auto& [lastUse, id] : candidates) {
+			if (memoryUsage_ <= memoryBudget_) {
+				break;
+			}
+			Evict(id);
+		}
+	}
+
+	// 参照されていないアセットをすべて捨てる
+	void Clear() {
+		std::vector<uint64_t> unreferenced;
+		for (const auto& [id, entry] : entries_) {
+			if (entry.asset.use_count() == 1) {
+				unreferenced.push_back(id);
+			}
+		}
+		for (uint64_t id : unreferenced) {
+			Evict(id);
+		}
+	}
+
+private:
+	// 中身のキーから、登録済みのアセットを読み込んだファイルのパス。ワーカーが要求した時点の状態を読む
+	using ContentSnapshot = std::unordered_multimap<AssetContentKey, std::string, AssetContentKeyHash>;
+
+	// LoadAsyncに渡された関数。読み込み直すときにも使うので共有する
+	template <typename LoadFunc, typename CreateFunc, typename DiscardFunc>
+	struct AsyncFunctions {
+		LoadFunc load;
+		CreateFunc create;
+		DiscardFunc discard;
+	};
+
+	template <typename Functions>
+	void RequestLoad(AssetLoader& loader, const std::string& normalizedPath, std::shared_ptr<Functions> functions, std::shared_ptr<const ContentSnapshot> snapshot) {
+		using Loaded = std::invoke_result_t<decltype(functions->load)&, const std::string&, std::string_view>;
+		struct Result {
+			AssetContentKey contentKey;
+			std::string sharedPath; // 中身が同じだった登録済みのファイル。空でなければloadは呼んでいない
+			std::optional<Loaded> loaded;
+		};
+		loader.Request(
+			[normalizedPath, functions, snapshot = std::move(snapshot)]() {
+				// 1度マップした中身から、キーを求めて比べ、そのまま読み込む
+				MappedFile file;
+				const bool isOpen = file.Open(normalizedPath);
+				assert(isOpen);
+				Result result = { GetContentKey(file.GetView()), {}, std::nullopt };
+				if (snapshot) {
+					const auto [begin, end] = snapshot->equal_range(result.contentKey);
+					for (auto candidateIt = begin; candidateIt != end; ++candidateIt) {
+						if (FileContentsEqual(candidateIt->second, file.GetView())) {
+							result.sharedPath = candidateIt->second;
+							return result;
+						}
+					}
+				}
+				result.loaded.emplace(functions->load(normalizedPath, file.GetView()));
+				return result;
+			},
+			[this, &loader, normalizedPath, functions](Result&& result) {
+				Handle asset = FindNormalized(normalizedPath);
+				if (asset) {
+					// 読み込み中にLoadで同じパスが登録された
+					if (result.loaded) {
+						functions->discard(*result.loaded);
+					}
+				} else if (!result.loaded) {
+					asset = ShareContent(normalizedPath, result.sharedPath, result.contentKey);
+					if (!asset) {
+						// 比べた後に捨てられていたので、比べずに読み込み直す。待っている要求はそのまま待つ
+						RequestLoad(loader, normalizedPath, functions, nullptr);
+						return;
+					}
+				} else {
+					asset = Insert(normalizedPath, result.contentKey, functions->create(std::move(*result.loaded)));
+				}
+				// 待っていた要求に渡す。コールバックの中で同じパスを要求しても登録済みとして扱われる
+				std::vector<std::function<void(const Handle&)>> waiters = std::move(pending_.at(normalizedPath));
+				pending_.erase(normalizedPath);
+				for (std::function<void(const Handle&)>& waiter : waiters) {
+					waiter(asset);
+				}
+			},
+			[functions](Result&& result) {
+				if (result.loaded) {
+					functions->discard(*result.loaded);
+				}
+			});
+	}
+
+	// 登録が変わったときだけ作り直す
+	std::shared_ptr<const ContentSnapshot> GetContentSnapshot() {
+		if (!snapshot_) {
+			std::shared_ptr<ContentSnapshot> snapshot = std::make_shared<ContentSnapshot>();
+			for (const auto& [id, entry] : entries_) {
+				snapshot->emplace(entry.contentKey, entry.paths.front());
+			}
+			snapshot_ = std::move(snapshot);
+		}
+		return snapshot_;
+	}
+
+	struct Entry {
+		Handle asset;
+		size_t memorySize;
+		uint64_t lastUse;
+		AssetContentKey contentKey;
+		std::vector<std::string> paths; // このアセットを指している正規化したパス。先頭は読み込んだファイル
+	};
+
+	Handle FindNormalized(const std::string& normalizedPath) {
+		const auto pathIt = paths_.find(normalizedPath);
+		if (pathIt == paths_.end()) {
+			return nullptr;
+		}
+		Entry& entry = entries_.at(pathIt->second);
+		entry.lastUse = ++useCounter_;
+		return entry.asset;
+	}
+
+	// 中身が同じものが登録済みなら、normalizedPathもそれを指すようにして返す
+	// ハッシュとサイズが同じものは、読み込んだファイルとバイト列を比べて確かめる
+	Handle FindContent(const std::string& normalizedPath, const AssetContentKey& contentKey, std::string_view contents) {
+		const auto [begin, end] = contents_.equal_range(contentKey);
+		for (auto contentIt = begin; contentIt != end; ++contentIt) {
+			if (FileContentsEqual(entries_.at(contentIt->second).paths.front(), contents)) {
+				return AddPath(normalizedPath, contentIt->second);
+			}
+		}
+		return nullptr;
+	}
+
+	// ワーカーで中身が同じと確かめたsharedPathのアセットを、normalizedPathからも指すようにして返す
+	// 比べた後に捨てられたか、別の中身に置き換わっていればnullptr
+	Handle ShareContent(const std::string& normalizedPath, const std::string& sharedPath, const AssetContentKey& contentKey) {
+		const auto pathIt = paths_.find(sharedPath);
+		if (pathIt == paths_.end() || entries_.at(pathIt->second).contentKey != contentKey) {
+			return nullptr;
+		}
+		return AddPath(normalizedPath, pathIt->second);
+	}
+
+	Handle AddPath(const std::string& normalizedPath, uint64_t id) {
+		Entry& entry = entries_.at(id);
+		if (paths_.emplace(normalizedPath, id).second) {
+			entry.paths.push_back(normalizedPath);
+		}
+		entry.lastUse = ++useCounter_;
+		return entry.asset;
+	}
+
+	Handle Insert(const std::string& normalizedPath, const AssetContentKey& contentKey, T&& asset) {
+		Handle created = release_ ? Handle(new T(std::move(asset)), [release = release_](T* pointer) { release(*pointer); delete pointer; }) : std::make_shared<T>(std::move(asset));
+		Entry entry = { std::move(created), 0, ++useCounter_, contentKey, { normalizedPath } };
+		entry.memorySize = getMemorySize_(*entry.asset);
+		Handle handle = entry.asset;
+		memoryUsage_ += entry.memorySize;
+		const uint64_t id = nextId_++;
+		paths_.emplace(normalizedPath, id);
+		contents_.emplace(contentKey, id);
+		entries_.emplace(id, std::move(entry));
+		snapshot_.reset();
+		// 今返すものは参照されているので捨てられない
+		Trim();
+		return handle;
+	}
+
+	void Evict(uint64_t id) {
+		const auto entryIt = entries_.find(id);
+		for (const std::string& path : entryIt->second.paths) {
+			paths_.erase(path);
+		}
+		const auto [begin, end] = contents_.equal_range(entryIt->second.contentKey);
+		contents_.erase(std::find_if(begin, end, [id](const auto& content) { return content.second == id; }));
+		memoryUsage_ -= entryIt->second.memorySize;
+		entries_.erase(entryIt);
+		snapshot_.reset();
+	}
+
+	std::function<size_t(const T&)> getMemorySize_;
+	std::function<void(T&)> release_;
+	size_t memoryBudget_;
+	size_t memoryUsage_ = 0;
+	uint64_t useCounter_ = 0;
+	uint64_t nextId_ = 0;
+
+	std::unordered_map<uint64_t, Entry> entries_; // エントリーの番号から
+	std::unordered_multimap<AssetContentKey, uint64_t, AssetContentKeyHash> contents_; // 中身のキーからエントリーの番号（衝突したものは複数並ぶ）
+	std::unordered_map<std::string, uint64_t> paths_; // 正規化したパスからエントリーの番号
+	std::shared_ptr<const ContentSnapshot> snapshot_; // 最後に作ったcontents_の写し。登録が変わったら作り直す
+	std::unordered_map<std::string, std::vector<std::function<void(const Handle&)>>> pending_; // 読み込み中のパスと待っている要求
+};
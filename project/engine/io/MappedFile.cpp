@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& filePath) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(std::filesystem::path(filePath).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle_ = file;
+    size_ = size_t(fileSize.QuadPart);
+    isOpen_ = true;
+    // 空のファイルはマップできないので、空のビューとして扱う
+    if (size_ == 0) {
+        return true;
+    }
+
+    mappingHandle_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle_ == nullptr) {
+        Close();
+        return false;
+    }
+    data_ = static_cast<const char*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        Close();
+        return false;
+    }
+#else
+    int file = open(filePath.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        return false;
+    }
+    size_ = size_t(status.st_size);
+    isOpen_ = true;
+    if (size_ != 0) {
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED) {
+            close(file);
+            size_ = 0;
+            isOpen_ = false;
+            return false;
+        }
+        // 先頭から順に読むことを伝えて先読みさせる
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+    // マップした後はファイルを閉じてもよい
+    close(file);
+#endif
+
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(fileHandle_);
+        fileHandle_ = nullptr;
+    }
+#else
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 読み込み専用でメモリにマップしたファイル
+// 中身をコピーせずにstring_viewとして参照できる
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// ファイルを開いてマップする。失敗したらfalse
+	bool Open(const std::string& filePath);
+	// マップを解除して閉じる
+	void Close();
+
+	// マップした中身
+	std::string_view GetView() const { return { data_, size_ }; }
+	size_t GetSize() const { return size_; }
+	bool IsOpen() const { return isOpen_; }
+
+private:
+	const char* data_ = nullptr;
+	size_t size_ = 0;
+	bool isOpen_ = false;
+#ifdef _WIN32
+	void* fileHandle_ = nullptr;
+	void* mappingHandle_ = nullptr;
+#endif
+};
@@ -0,0 +1,271 @@
+#include "MeshFile.h"
+#include "ObjLoader.h"
+#include "engine/3d/MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+    // 頂点とIndexを置く境界
+    const uint64_t kDataAlignment = 16;
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 範囲がファイルに収まっているか
+    bool IsInFile(uint64_t offset, uint64_t size, uint64_t fileSize) {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+bool WriteMeshFile(const std::string& filePath, const ModelData& modelData, const std::string& directoryPath) {
+    // Indexがなければ3頂点ずつの三角形として作る
+    std::vector<uint32_t> sequentialIndices;
+    const std::vector<uint32_t>* indices = &modelData.indices;
+    if (indices->empty()) {
+        sequentialIndices.resize(modelData.verticles.size());
+        for (uint32_t i = 0; i < uint32_t(sequentialIndices.size()); i++) {
+            sequentialIndices[i] = i;
+        }
+        indices = &sequentialIndices;
+    }
+
+    MeshFileHeader header = {};
+    std::memcpy(header.magic, "MESH", 4);
+    header.version = kMeshFileVersion;
+    header.vertexStride = sizeof(VertexData);
+    header.indexSize = CanUse16BitIndices(modelData) ? sizeof(uint16_t) : sizeof(uint32_t);
+    header.vertexCount = uint32_t(modelData.verticles.size());
+    header.indexCount = uint32_t(indices->size());
+
+    // サブメッシュがなければ全体を1つのサブメッシュにする
+    std::vector<MaterialData> materials = modelData.materials;
+    std::vector<SubmeshData> submeshes = modelData.submeshes;
+    if (submeshes.empty()) {
+        materials = { modelData.material };
+        submeshes = { { "", 0, header.indexCount, 0, modelData.bounds } };
+    }
+    header.submeshCount = uint32_t(submeshes.size());
+    header.materialCount = uint32_t(materials.size());
+
+    // 文字列は1か所にまとめて置く
+    std::string strings;
+    auto addString = [&](const std::string& value, uint32_t& offset, uint32_t& length) {
+        offset = uint32_t(strings.size());
+        length = uint32_t(value.size());
+        strings += value;
+    };
+    std::vector<MeshFileSubmesh> fileSubmeshes(submeshes.size());
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        fileSubmeshes[i] = { submeshes[i].indexOffset, submeshes[i].indexCount, submeshes[i].materialIndex, 0, 0, 0, {}, {}, {}, 0.0f };
+        addString(submeshes[i].name, fileSubmeshes[i].nameOffset, fileSubmeshes[i].nameLength);
+    }
+    // テクスチャのパスはディレクトリからの相対パスにする
+    const std::string prefix = directoryPath + "/";
+    std::vector<MeshFileMaterial> fileMaterials(materials.size());
+    for (size_t i = 0; i < materials.size(); i++) {
+        std::string textureFilePath = materials[i].textureFilePath;
+        if (textureFilePath.compare(0, prefix.size(), prefix) == 0) {
+            textureFilePath.erase(0, prefix.size());
+        }
+        addString(materials[i].name, fileMaterials[i].nameOffset, fileMaterials[i].nameLength);
+        addString(textureFilePath, fileMaterials[i].textureFilePathOffset, fileMaterials[i].textureFilePathLength);
+    }
+
+    // 境界
+    auto writeBounds = [](const MeshBounds& bounds, float* aabbMin, float* aabbMax, float* sphereCenter, float& sphereRadius) {
+        std::memcpy(aabbMin, &bounds.aabb.min, sizeof(float) * 3);
+        std::memcpy(aabbMax, &bounds.aabb.max, sizeof(float) * 3);
+        std::memcpy(sphereCenter, &bounds.sphere.center, sizeof(float) * 3);
+        sphereRadius = bounds.sphere.radius;
+    };
+    writeBounds(modelData.bounds, header.aabbMin, header.aabbMax, header.sphereCenter, header.sphereRadius);
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        writeBounds(submeshes[i].bounds, fileSubmeshes[i].aabbMin, fileSubmeshes[i].aabbMax, fileSubmeshes[i].sphereCenter, fileSubmeshes[i].sphereRadius);
+    }
+
+    // 配置を決める
+    header.submeshOffset = sizeof(MeshFileHeader);
+    header.materialOffset = header.submeshOffset + sizeof(MeshFileSubmesh) * header.submeshCount;
+    header.stringOffset = header.materialOffset + sizeof(MeshFileMaterial) * header.materialCount;
+    header.vertexOffset = AlignUp(header.stringOffset + strings.size(), kDataAlignment);
+    uint64_t vertexEnd = header.vertexOffset + uint64_t(header.vertexStride) * header.vertexCount;
+    if (!modelData.tangents.empty()) {
+        assert(modelData.tangents.size() == modelData.verticles.size());
+        header.tangentOffset = AlignUp(vertexEnd, kDataAlignment);
+        vertexEnd = header.tangentOffset + sizeof(Vector4) * uint64_t(header.vertexCount);
+    }
+    header.indexOffset = AlignUp(vertexEnd, kDataAlignment);
+    const uint64_t fileSize = header.indexOffset + uint64_t(header.indexSize) * header.indexCount;
+
+    std::vector<char> buffer(fileSize, 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + header.submeshOffset, fileSubmeshes.data(), sizeof(MeshFileSubmesh) * fileSubmeshes.size());
+    std::memcpy(buffer.data() + header.materialOffset, fileMaterials.data(), sizeof(MeshFileMaterial) * fileMaterials.size());
+    std::memcpy(buffer.data() + header.stringOffset, strings.data(), strings.size());
+    std::memcpy(buffer.data() + header.vertexOffset, modelData.verticles.data(), sizeof(VertexData) * modelData.verticles.size());
+    if (header.tangentOffset != 0) {
+        std::memcpy(buffer.data() + header.tangentOffset, modelData.tangents.data(), sizeof(Vector4) * modelData.tangents.size());
+    }
+    if (header.indexSize == sizeof(uint16_t)) {
+        uint16_t* indexData = reinterpret_cast<uint16_t*>(buffer.data() + header.indexOffset);
+        for (size_t i = 0; i < indices->size(); i++) {
+            indexData[i] = uint16_t((*indices)[i]);
+        }
+    } else {
+        std::memcpy(buffer.data() + header.indexOffset, indices->data(), sizeof(uint32_t) * indices->size());
+    }
+
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(buffer.data(), std::streamsize(buffer.size()));
+    return file.good();
+}
+
+bool MeshFile::Open(const std::string& filePath) {
+    header_ = nullptr;
+    if (!file_.Open(filePath)) {
+        return false;
+    }
+
+    // 形式の確認
+    const uint64_t fileSize = file_.GetSize();
+    if (fileSize < sizeof(MeshFileHeader)) {
+        return false;
+    }
+    const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(file_.GetView().data());
+    if (std::memcmp(header->magic, "MESH", 4) != 0 || header->version != kMeshFileVersion || header->vertexStride != sizeof(VertexData) ||
+        (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t))) {
+        return false;
+    }
+    if (!IsInFile(header->vertexOffset, uint64_t(header->vertexStride) * header->vertexCount, fileSize) ||
+        !IsInFile(header->indexOffset, uint64_t(header->indexSize) * header->indexCount, fileSize) ||
+        !IsInFile(header->submeshOffset, sizeof(MeshFileSubmesh) * uint64_t(header->submeshCount), fileSize) ||
+        !IsInFile(header->materialOffset, sizeof(MeshFileMaterial) * uint64_t(header->materialCount), fileSize) ||
+        !IsInFile(header->stringOffset, 0, fileSize) ||
+        (header->tangentOffset != 0 && !IsInFile(header->tangentOffset, sizeof(Vector4) * uint64_t(header->vertexCount), fileSize))) {
+        return false;
+    }
+    const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(file_.GetView().data() + header->submeshOffset);
+    for (uint32_t i = 0; i < header->submeshCount; i++) {
+        if (!IsInFile(submeshes[i].indexOffset, submeshes[i].indexCount, header->indexCount) || submeshes[i].materialIndex >= header->materialCount ||
+            !IsInFile(header->stringOffset + submeshes[i].nameOffset, submeshes[i].nameLength, fileSize)) {
+            return false;
+        }
+    }
+    const MeshFileMaterial* materials = reinterpret_cast<const MeshFileMaterial*>(file_.GetView().data() + header->materialOffset);
+    for (uint32_t i = 0; i < header->materialCount; i++) {
+        if (!IsInFile(header->stringOffset + materials[i].nameOffset, materials[i].nameLength, fileSize) ||
+            !IsInFile(header->stringOffset + materials[i].textureFilePathOffset, materials[i].textureFilePathLength, fileSize)) {
+            return false;
+        }
+    }
+    // 頂点の範囲を超えるIndexがあれば壊れたファイルとして扱う
+    if (header->indexCount != 0) {
+        const char* indexData = file_.GetView().data() + header->indexOffset;
+        uint32_t maxIndex = 0;
+        if (header->indexSize == sizeof(uint16_t)) {
+            const uint16_t* indices = reinterpret_cast<const uint16_t*>(indexData);
+            maxIndex = *std::max_element(indices, indices + header->indexCount);
+        } else {
+            const uint32_t* indices = reinterpret_cast<const uint32_t*>(indexData);
+            maxIndex = *std::max_element(indices, indices + header->indexCount);
+        }
+        if (maxIndex >= header->vertexCount) {
+            return false;
+        }
+    }
+
+    header_ = header;
+    return true;
+}
+
+std::string_view MeshFile::GetString(uint32_t offset, uint32_t length) const {
+    return { static_cast<const char*>(Get(header_->stringOffset + offset)), length };
+}
+
+ModelData MeshFile::ToModelData(const std::string& directoryPath) const {
+    ModelData modelData;
+
+    const VertexData* vertices = static_cast<const VertexData*>(GetVertexData());
+    modelData.verticles.assign(vertices, vertices + header_->vertexCount);
+    if (const Vector4* tangents = GetTangentData()) {
+        modelData.tangents.assign(tangents, tangents + header_->vertexCount);
+    }
+
+    modelData.indices.resize(header_->indexCount);
+    if (header_->indexSize == sizeof(uint16_t)) {
+        const uint16_t* indices = static_cast<const uint16_t*>(GetIndexData());
+        std::copy(indices, indices + header_->indexCount, modelData.indices.begin());
+    } else {
+        std::memcpy(modelData.indices.data(), GetIndexData(), sizeof(uint32_t) * header_->indexCount);
+    }
+
+    modelData.materials.resize(header_->materialCount);
+    for (uint32_t i = 0; i < header_->materialCount; i++) {
+        const MeshFileMaterial& material = GetMaterials()[i];
+        modelData.materials[i].name = GetString(material.nameOffset, material.nameLength);
+        if (material.textureFilePathLength != 0) {
+            modelData.materials[i].textureFilePath = directoryPath + "/" + std::string(GetString(material.textureFilePathOffset, material.textureFilePathLength));
+        }
+    }
+    // 境界はファイルに入っているものを使い、頂点を調べ直さない
+    auto readBounds = [](const float* aabbMin, const float* aabbMax, const float* sphereCenter, float sphereRadius) {
+        return MeshBounds{ { { aabbMin[0], aabbMin[1], aabbMin[2] }, { aabbMax[0], aabbMax[1], aabbMax[2] } },
+            { { sphereCenter[0], sphereCenter[1], sphereCenter[2] }, sphereRadius } };
+    };
+    modelData.bounds = readBounds(header_->aabbMin, header_->aabbMax, header_->sphereCenter, header_->sphereRadius);
+    modelData.submeshes.resize(header_->submeshCount);
+    for (uint32_t i = 0; i < header_->submeshCount; i++) {
+        const MeshFileSubmesh& submesh = GetSubmeshes()[i];
+        modelData.submeshes[i] = { std::string(GetString(submesh.nameOffset, submesh.nameLength)), submesh.indexOffset, submesh.indexCount, submesh.materialIndex,
+            readBounds(submesh.aabbMin, submesh.aabbMax, submesh.sphereCenter, submesh.sphereRadius) };
+    }
+
+    // 互換のため、先頭のサブメッシュのマテリアルをmaterialにも入れる
+    if (!modelData.submeshes.empty()) {
+        modelData.material = modelData.materials[modelData.submeshes.front().materialIndex];
+    } else if (!modelData.materials.empty()) {
+        modelData.material = modelData.materials.front();
+    }
+
+    return modelData;
+}
+
+ModelData LoadMeshFile(const std::string& directoryPath, const std::string& filename) {
+    MeshFile meshFile;
+    [[maybe_unused]] bool isOpen = meshFile.Open(directoryPath + "/" + filename);
+    assert(isOpen); // とりあえず開けなかったら止める
+    return meshFile.ToModelData(directoryPath);
+}
+
+ModelData LoadModelFile(const std::string& directoryPath, const std::string& filename) {
+    const std::filesystem::path sourcePath = std::filesystem::path(directoryPath) / filename;
+    std::filesystem::path cookedPath = sourcePath;
+    cookedPath.replace_extension(".mesh");
+
+    // 変換済みのファイルがobjより新しければそちらを使う
+    std::error_code errorCode;
+    const auto cookedTime = std::filesystem::last_write_time(cookedPath, errorCode);
+    if (!errorCode) {
+        const auto sourceTime = std::filesystem::last_write_time(sourcePath, errorCode);
+        MeshFile meshFile;
+        if ((errorCode || sourceTime <= cookedTime) && meshFile.Open(cookedPath.string())) {
+            return meshFile.ToModelData(directoryPath);
+        }
+    }
+
+    ObjLoadOptions options;
+    options.numThreads = 0;
+    options.indexed = true;
+    options.generateTangents = true;
+    ModelData modelData = LoadObjFile(directoryPath, filename, options);
+    OptimizeMesh(modelData);
+    return modelData;
+}
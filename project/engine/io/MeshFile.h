@@ -0,0 +1,98 @@
+#pragma once
+#include "engine/3d/ModelData.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+// 変換済みメッシュファイル（.mesh）
+// objを解析し直さずに読めるよう、頂点・接線・Index・サブメッシュ・マテリアル・境界をそのまま並べたバイナリ
+// 頂点・接線・Indexは16バイト境界に置いてあるので、マップしたままアップロードバッファへmemcpyできる
+// 数値はすべてリトルエンディアン
+
+// ファイルの先頭
+struct MeshFileHeader {
+	char magic[4]; // "MESH"
+	uint32_t version;
+	uint32_t vertexStride; // 1頂点のバイト数
+	uint32_t indexSize; // Indexのバイト数（2か4）
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t submeshCount;
+	uint32_t materialCount;
+	// ファイル先頭からのバイトオフセット
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	uint64_t submeshOffset;
+	uint64_t materialOffset;
+	uint64_t stringOffset;
+	uint64_t tangentOffset; // 接線（Vector4 * vertexCount）。0なら接線なし
+	// メッシュ全体の境界
+	float aabbMin[3];
+	float aabbMax[3];
+	float sphereCenter[3];
+	float sphereRadius;
+};
+static_assert(sizeof(MeshFileHeader) == 120, "MeshFileHeaderの配置を変えたらkMeshFileVersionを上げること");
+
+// サブメッシュ（Indexの範囲とマテリアルと境界）。文字列はstringOffsetからの位置と長さ
+struct MeshFileSubmesh {
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	uint32_t materialIndex;
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	uint32_t reserved;
+	float aabbMin[3];
+	float aabbMax[3];
+	float sphereCenter[3];
+	float sphereRadius;
+};
+static_assert(sizeof(MeshFileSubmesh) == 64, "MeshFileSubmeshの配置を変えたらkMeshFileVersionを上げること");
+
+// マテリアル。文字列はstringOffsetからの位置と長さ
+struct MeshFileMaterial {
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	uint32_t textureFilePathOffset;
+	uint32_t textureFilePathLength;
+};
+
+// 現在の形式の番号。形式を変えたら上げる
+const uint32_t kMeshFileVersion = 4;
+
+// ModelDataを.meshとして書き出す。境界はComputeModelBoundsで求めたものをそのまま書く
+// テクスチャのパスはdirectoryPathからの相対パスで保存する
+bool WriteMeshFile(const std::string& filePath, const ModelData& modelData, const std::string& directoryPath);
+
+// マップした.meshファイル
+class MeshFile {
+public:
+	// ファイルを開く。形式が違うか、範囲外を指すオフセットやIndexがあればfalse
+	bool Open(const std::string& filePath);
+
+	const MeshFileHeader& GetHeader() const { return *header_; }
+	// 頂点データの先頭（vertexStride * vertexCountバイト）
+	const void* GetVertexData() const { return Get(header_->vertexOffset); }
+	// 接線データの先頭（sizeof(Vector4) * vertexCountバイト）。なければnullptr
+	const Vector4* GetTangentData() const { return header_->tangentOffset != 0 ? static_cast<const Vector4*>(Get(header_->tangentOffset)) : nullptr; }
+	// Indexデータの先頭（indexSize * indexCountバイト）
+	const void* GetIndexData() const { return Get(header_->indexOffset); }
+	const MeshFileSubmesh* GetSubmeshes() const { return static_cast<const MeshFileSubmesh*>(Get(header_->submeshOffset)); }
+	const MeshFileMaterial* GetMaterials() const { return static_cast<const MeshFileMaterial*>(Get(header_->materialOffset)); }
+	std::string_view GetString(uint32_t offset, uint32_t length) const;
+
+	// ModelDataへ展開する。テクスチャのパスの先頭にdirectoryPathを付ける
+	ModelData ToModelData(const std::string& directoryPath) const;
+
+private:
+	const void* Get(uint64_t offset) const { return file_.GetView().data() + offset; }
+
+	MappedFile file_;
+	const MeshFileHeader* header_ = nullptr;
+};
+
+// .meshファイルを読み込む
+ModelData LoadMeshFile(const std::string& directoryPath, const std::string& filename);
+
+// モデルを読み込む。objと同じ名前の.meshがobjより新しければそちらを読み、なければobjを解析して最適化する
+ModelData LoadModelFile(const std::string& directoryPath, const std::string& filename);
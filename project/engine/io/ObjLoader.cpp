@@ -0,0 +1,794 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "engine/3d/MeshBounds.h"
+#include "engine/3d/TangentSpace.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    // 行の中の区切り文字か
+    bool IsBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // 空白を読み飛ばす（改行は読み飛ばさない）
+    void SkipBlanks(const char*& p, const char* end) {
+        while (p < end && IsBlank(*p)) {
+            p++;
+        }
+    }
+
+    // 次の行の先頭へ進む
+    void SkipLine(const char*& p, const char* end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        p = newline != nullptr ? newline + 1 : end;
+    }
+
+    // 空白で区切られた単語を1つ読む
+    std::string_view ReadToken(const char*& p, const char* end) {
+        SkipBlanks(p, end);
+        const char* begin = p;
+        while (p < end && !IsBlank(*p) && *p != '\n') {
+            p++;
+        }
+        return { begin, size_t(p - begin) };
+    }
+
+    // 実数を1つ読む
+    float ReadFloat(const char*& p, const char* end) {
+        SkipBlanks(p, end);
+        // from_charsは先頭の+を受け付けない
+        if (p < end && *p == '+') {
+            p++;
+        }
+        float value = 0.0f;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        p = result.ptr;
+        return value;
+    }
+
+    // 整数を1つ読む
+    int32_t ReadInt(const char*& p, const char* end) {
+        int32_t value = 0;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        p = result.ptr;
+        return value;
+    }
+
+    // 1チャンクの最小サイズ。これより小さいファイルは分割しない
+    const size_t kMinChunkSize = 1 << 20;
+
+    // 同じオブジェクト名とマテリアル名が続く面の並び
+    struct ObjRun {
+        std::string_view objectName;
+        std::string_view materialName;
+        // falseなら前の並びの名前を引き継ぐ
+        bool hasObjectName = false;
+        bool hasMaterialName = false;
+        // チャンク内の三角形の範囲
+        size_t triangleBegin = 0;
+        size_t triangleEnd = 0;
+        // 書き込み先の三角形の番号
+        size_t destination = 0;
+    };
+
+    // 扇形に分割した多角形の位置
+    struct ObjPolygon {
+        size_t triangleBegin;
+        uint32_t vertexCount;
+    };
+
+    // 面の頂点1つ分の「位置/UV/法線」のIndex
+    struct ObjFaceVertex {
+        int32_t elementIndices[3];
+        uint32_t relativeMask; // 負のIndexから直した要素のビット
+    };
+
+    // objの1チャンク分の解析結果
+    struct ObjChunk {
+        std::vector<Vector4> positions;
+        std::vector<Vector2> texcoords;
+        std::vector<Vector3> normals;
+        // 三角形ごとに3頂点分の「位置/UV/法線」のIndex（1始まり。ない要素は0）
+        std::vector<int32_t> faces;
+        // facesのうち、負のIndexをチャンク内の番号に直したものの位置。チャンクの先頭の要素数を足すと通し番号になる
+        std::vector<size_t> relativeFaces;
+        // 4頂点以上の多角形。facesには扇形に分割して入っている
+        std::vector<ObjPolygon> polygons;
+        // o/g/usemtlで区切った面の並び。先頭は前のチャンクの状態を引き継ぐ
+        std::vector<ObjRun> runs = { ObjRun{} };
+        // 出てきた順のmtllibのファイル名
+        std::vector<std::string_view> materialFilenames;
+    };
+
+    // 次の面から新しい並びを始める。直前の並びが空ならそれを書き換える
+    ObjRun& BeginRun(ObjChunk& chunk) {
+        const size_t triangle = chunk.faces.size() / 9;
+        if (chunk.runs.back().triangleBegin != triangle) {
+            ObjRun run = chunk.runs.back();
+            run.triangleBegin = triangle;
+            chunk.runs.push_back(run);
+        }
+        return chunk.runs.back();
+    }
+
+    // 前のチャンクまでの要素数
+    struct ObjChunkOffset {
+        size_t position;
+        size_t texcoord;
+        size_t normal;
+        size_t triangle;
+    };
+
+    // 面の頂点を1つ読む。「位置」「位置/UV」「位置//法線」「位置/UV/法線」のどれでもよく、ない要素は0にする
+    // 負のIndexはその行までの要素からの相対参照なので、チャンク内の番号に直す
+    bool ReadFaceVertex(const char*& p, const char* end, const ObjChunk& chunk, ObjFaceVertex& faceVertex) {
+        SkipBlanks(p, end);
+        if (p == end || *p == '\n' || *p == '#') {
+            return false;
+        }
+        faceVertex.relativeMask = 0;
+        for (int32_t element = 0; element < 3; ++element) {
+            faceVertex.elementIndices[element] = 0;
+            if (element != 0) {
+                if (p == end || *p != '/') {
+                    continue;
+                }
+                p++;
+            }
+            faceVertex.elementIndices[element] = ReadInt(p, end);
+            if (faceVertex.elementIndices[element] < 0) {
+                const size_t counts[3] = { chunk.positions.size(), chunk.texcoords.size(), chunk.normals.size() };
+                faceVertex.elementIndices[element] += int32_t(counts[element]) + 1;
+                faceVertex.relativeMask |= 1u << element;
+            }
+        }
+        // 読めなかった文字は読み飛ばす
+        while (p < end && !IsBlank(*p) && *p != '\n') {
+            p++;
+        }
+        return true;
+    }
+
+    // 面の頂点を1つ追加する
+    void AddFaceVertex(ObjChunk& chunk, const ObjFaceVertex& faceVertex) {
+        if (faceVertex.relativeMask != 0) {
+            for (int32_t element = 0; element < 3; ++element) {
+                if ((faceVertex.relativeMask & (1u << element)) != 0) {
+                    chunk.relativeFaces.push_back(chunk.faces.size() + element);
+                }
+            }
+        }
+        chunk.faces.insert(chunk.faces.end(), faceVertex.elementIndices, faceVertex.elementIndices + 3);
+    }
+
+    // 2次元の外積
+    float Cross2(float ax, float ay, float bx, float by) {
+        return ax * by - ay * bx;
+    }
+
+    // 点が三角形abcの内側（辺上を含む）にあるか。三角形は反時計回り
+    bool IsInTriangle(const float* a, const float* b, const float* c, const float* point) {
+        return Cross2(b[0] - a[0], b[1] - a[1], point[0] - a[0], point[1] - a[1]) >= 0.0f &&
+            Cross2(c[0] - b[0], c[1] - b[1], point[0] - b[0], point[1] - b[1]) >= 0.0f &&
+            Cross2(a[0] - c[0], a[1] - c[1], point[0] - c[0], point[1] - c[1]) >= 0.0f;
+    }
+
+    // 扇形に分割した多角形が凹んでいれば、耳切り法で分割し直す（三角形の数は変わらない）
+    // points・remainingは作業用。呼び出し側で使い回す
+    void TriangulatePolygon(int32_t* faces, uint32_t vertexCount, const std::vector<Vector4>& positions,
+        std::vector<ObjFaceVertex>& polygon, std::vector<float>& points, std::vector<uint32_t>& remaining) {
+        // 扇形の三角形(0, k + 1, k + 2)から元の頂点の並びを取り出す
+        polygon.resize(vertexCount);
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            const int32_t* source = vertex == 0 ? &faces[0] : vertex + 1 < vertexCount ? &faces[(vertex - 1) * 9 + 3] : &faces[(vertexCount - 3) * 9 + 6];
+            std::copy(source, source + 3, polygon[vertex].elementIndices);
+            if (polygon[vertex].elementIndices[0] < 1 || size_t(polygon[vertex].elementIndices[0]) > positions.size()) {
+                return; // 不正なIndexを含む三角形は後で取り除く
+            }
+        }
+
+        // Newellの方法で法線を求め、一番大きい軸を落として平面に投影する
+        Vector3 normal = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            const Vector4& current = positions[polygon[vertex].elementIndices[0] - 1];
+            const Vector4& next = positions[polygon[(vertex + 1) % vertexCount].elementIndices[0] - 1];
+            normal.x += (current.y - next.y) * (current.z + next.z);
+            normal.y += (current.z - next.z) * (current.x + next.x);
+            normal.z += (current.x - next.x) * (current.y + next.y);
+        }
+        const float absX = std::abs(normal.x), absY = std::abs(normal.y), absZ = std::abs(normal.z);
+        const int32_t axisU = absZ >= absX && absZ >= absY ? 0 : absX >= absY ? 1 : 2;
+        const int32_t axisV = (axisU + 1) % 3;
+        // 投影した多角形が反時計回りになるよう、法線の向きで片方の軸を反転する
+        const float dominant = axisU == 0 ? normal.z : axisU == 1 ? normal.x : normal.y;
+        if (dominant == 0.0f) {
+            return; // 面積がない
+        }
+        const float flip = dominant > 0.0f ? 1.0f : -1.0f;
+        points.resize(vertexCount * 2);
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            const Vector4& position = positions[polygon[vertex].elementIndices[0] - 1];
+            const float coordinates[3] = { position.x, position.y, position.z };
+            points[vertex * 2 + 0] = coordinates[axisU];
+            points[vertex * 2 + 1] = coordinates[axisV] * flip;
+        }
+
+        // 凸なら扇形のままでよい
+        auto isConvex = [&](uint32_t a, uint32_t b, uint32_t c) {
+            return Cross2(points[b * 2] - points[a * 2], points[b * 2 + 1] - points[a * 2 + 1], points[c * 2] - points[b * 2], points[c * 2 + 1] - points[b * 2 + 1]) > 0.0f;
+        };
+        bool isConvexPolygon = true;
+        for (uint32_t vertex = 0; vertex < vertexCount && isConvexPolygon; vertex++) {
+            isConvexPolygon = isConvex((vertex + vertexCount - 1) % vertexCount, vertex, (vertex + 1) % vertexCount);
+        }
+        if (isConvexPolygon) {
+            return;
+        }
+
+        // 耳（凸で、内側にほかの頂点がない角）を1つずつ切り取る
+        remaining.resize(vertexCount);
+        for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+            remaining[vertex] = vertex;
+        }
+        int32_t* out = faces;
+        auto emit = [&](uint32_t a, uint32_t b, uint32_t c) {
+            for (uint32_t vertex : { a, b, c }) {
+                std::copy(polygon[vertex].elementIndices, polygon[vertex].elementIndices + 3, out);
+                out += 3;
+            }
+        };
+        while (remaining.size() > 3) {
+            const size_t count = remaining.size();
+            bool isClipped = false;
+            for (size_t i = 0; i < count && !isClipped; i++) {
+                const uint32_t a = remaining[(i + count - 1) % count], b = remaining[i], c = remaining[(i + 1) % count];
+                if (!isConvex(a, b, c)) {
+                    continue;
+                }
+                bool isEar = true;
+                for (uint32_t other : remaining) {
+                    if (other != a && other != b && other != c && IsInTriangle(&points[a * 2], &points[b * 2], &points[c * 2], &points[other * 2])) {
+                        isEar = false;
+                        break;
+                    }
+                }
+                if (isEar) {
+                    emit(a, b, c);
+                    remaining.erase(remaining.begin() + i);
+                    isClipped = true;
+                }
+            }
+            // 自己交差などで耳が見つからなければ、残りは扇形にする
+            if (!isClipped) {
+                for (size_t i = 1; i + 1 < remaining.size(); i++) {
+                    emit(remaining[0], remaining[i], remaining[i + 1]);
+                }
+                return;
+            }
+        }
+        emit(remaining[0], remaining[1], remaining[2]);
+    }
+
+    // テキストを行の境界でおよそcount等分する
+    std::vector<std::string_view> SplitLines(std::string_view text, size_t count) {
+        std::vector<std::string_view> ranges;
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        for (size_t i = 1; i <= count; i++) {
+            const char* split = i == count ? end : text.data() + text.size() * i / count;
+            if (split < begin) {
+                split = begin;
+            }
+            // 行の途中なら次の行の先頭まで進める
+            if (split != end && split != text.data() && split[-1] != '\n') {
+                SkipLine(split, end);
+            }
+            if (split != begin) {
+                ranges.push_back({ begin, size_t(split - begin) });
+            }
+            begin = split;
+        }
+        if (ranges.empty()) {
+            ranges.push_back(text);
+        }
+        return ranges;
+    }
+
+    // func(0)～func(count - 1)をそれぞれ別のスレッドで実行する
+    template <typename Func>
+    void ParallelFor(size_t count, Func&& func) {
+        std::vector<std::thread> threads;
+        threads.reserve(count);
+        for (size_t i = 1; i < count; i++) {
+            threads.emplace_back([&func, i]() { func(i); });
+        }
+        if (count != 0) {
+            func(0);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // 「位置/UV/法線」のIndexの組から頂点番号を引く表（オープンアドレス法）
+    class VertexIndexTable {
+    public:
+        // 組が登録済みならその頂点番号を、なければnewIndexを登録して返す
+        uint32_t FindOrInsert(const int32_t* elementIndices, uint32_t newIndex) {
+            // 使用率が半分を超えたら広げる
+            if ((count_ + 1) * 2 > slots_.size()) {
+                Grow();
+            }
+            const size_t mask = slots_.size() - 1;
+            for (size_t slot = Hash(elementIndices) & mask;; slot = (slot + 1) & mask) {
+                Slot& entry = slots_[slot];
+                if (entry.index == kEmpty) {
+                    entry = { { elementIndices[0], elementIndices[1], elementIndices[2] }, newIndex };
+                    count_++;
+                    return newIndex;
+                }
+                if (entry.key[0] == elementIndices[0] && entry.key[1] == elementIndices[1] && entry.key[2] == elementIndices[2]) {
+                    return entry.index;
+                }
+            }
+        }
+
+    private:
+        static const uint32_t kEmpty = 0xFFFFFFFF;
+
+        struct Slot {
+            int32_t key[3];
+            uint32_t index = kEmpty;
+        };
+
+        static size_t Hash(const int32_t* key) {
+            uint64_t hash = uint64_t(uint32_t(key[0])) * 0x9E3779B97F4A7C15ull;
+            hash ^= uint64_t(uint32_t(key[1])) * 0xC2B2AE3D27D4EB4Full;
+            hash ^= uint64_t(uint32_t(key[2])) * 0x165667B19E3779F9ull;
+            return size_t(hash ^ (hash >> 29));
+        }
+
+        void Grow() {
+            std::vector<Slot> old = std::move(slots_);
+            slots_.assign(std::max<size_t>(old.size() * 2, 1024), Slot{});
+            count_ = 0;
+            for (const Slot& entry : old) {
+                if (entry.index != kEmpty) {
+                    FindOrInsert(entry.key, entry.index);
+                }
+            }
+        }
+
+        std::vector<Slot> slots_;
+        size_t count_ = 0;
+    };
+
+    // objの1チャンクを解析する。1行ずつ、行をコピーせずにその場で読む
+    void ParseObjChunk(std::string_view text, ObjChunk& chunk) {
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            std::string_view identifier = ReadToken(p, end); // 先頭の識別子を読む
+
+            // identifierに応じた処理
+            if (identifier == "v") {
+                Vector4 position;
+                position.x = ReadFloat(p, end);
+                position.y = ReadFloat(p, end);
+                position.z = ReadFloat(p, end);
+                position.x *= -1.0f;
+                position.w = 1.0f;
+                chunk.positions.push_back(position);
+            } else if (identifier == "vt") {
+                Vector2 texcoord;
+                texcoord.x = ReadFloat(p, end);
+                texcoord.y = ReadFloat(p, end);
+                texcoord.y = 1.0f - texcoord.y;
+                chunk.texcoords.push_back(texcoord);
+            } else if (identifier == "vn") {
+                Vector3 normal;
+                normal.x = ReadFloat(p, end);
+                normal.y = ReadFloat(p, end);
+                normal.z = ReadFloat(p, end);
+                normal.x *= -1.0f;
+                chunk.normals.push_back(normal);
+            } else if (identifier == "f") {
+                // 多角形はいったん扇形に分割しておき、要素がそろってから凹んだものを分割し直す
+                const size_t triangleBegin = chunk.faces.size() / 9;
+                ObjFaceVertex first, previous, current;
+                uint32_t vertexCount = 0;
+                while (ReadFaceVertex(p, end, chunk, current)) {
+                    if (vertexCount == 0) {
+                        first = current;
+                    } else if (vertexCount >= 2) {
+                        AddFaceVertex(chunk, first);
+                        AddFaceVertex(chunk, previous);
+                        AddFaceVertex(chunk, current);
+                    }
+                    previous = current;
+                    vertexCount++;
+                }
+                if (vertexCount >= 4) {
+                    chunk.polygons.push_back({ triangleBegin, vertexCount });
+                }
+            } else if (identifier == "o" || identifier == "g") {
+                // オブジェクト・グループの切り替え
+                ObjRun& run = BeginRun(chunk);
+                run.objectName = ReadToken(p, end);
+                run.hasObjectName = true;
+            } else if (identifier == "usemtl") {
+                // マテリアルの切り替え
+                ObjRun& run = BeginRun(chunk);
+                run.materialName = ReadToken(p, end);
+                run.hasMaterialName = true;
+            } else if (identifier == "mtllib") {
+                // materialTemplateLibraryファイルの名前を取得する
+                chunk.materialFilenames.push_back(ReadToken(p, end));
+            }
+
+            SkipLine(p, end);
+        }
+
+        // 最後の並びはチャンクの終わりまで
+        for (size_t i = 0; i < chunk.runs.size(); i++) {
+            chunk.runs[i].triangleEnd = i + 1 < chunk.runs.size() ? chunk.runs[i + 1].triangleBegin : chunk.faces.size() / 9;
+        }
+    }
+
+    // サブメッシュを作るときの、オブジェクト名とマテリアル名の組
+    struct ObjGroup {
+        std::string_view objectName;
+        std::string_view materialName;
+        uint32_t materialIndex;
+        size_t triangleCount;
+    };
+}
+
+std::vector<MaterialData> LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename) {
+    // ファイルをマップし、コピーせずに直接解析する
+    MappedFile file;
+    [[maybe_unused]] bool isOpen = file.Open(directoryPath + "/" + filename);
+    assert(isOpen); // とりあえず開けなかったら止める
+    return ParseMaterialTemplate(file.GetView(), directoryPath);
+}
+
+ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename, const ObjLoadOptions& options) {
+    // ファイルをマップし、コピーせずに直接解析する
+    MappedFile file;
+    [[maybe_unused]] bool isOpen = file.Open(directoryPath + "/" + filename);
+    assert(isOpen); // とりあえず開けなかったら止める
+    return ParseObj(file.GetView(), directoryPath, options);
+}
+
+std::vector<MaterialData> ParseMaterialTemplate(std::string_view text, const std::string& directoryPath) {
+    std::vector<MaterialData> materials; // 構築するMaterialData
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        std::string_view identifier = ReadToken(p, end);
+
+        // identifierに応じた処理
+        if (identifier == "newmtl") {
+            MaterialData materialData;
+            materialData.name = ReadToken(p, end);
+            materials.push_back(materialData);
+        } else if (identifier == "map_Kd") {
+            std::string_view textureFilename = ReadToken(p, end);
+            // newmtlより前に書かれていれば名前のないマテリアルとする
+            if (materials.empty()) {
+                materials.emplace_back();
+            }
+            // 連結してファイルパスにする
+            materials.back().textureFilePath = directoryPath + "/" + std::string(textureFilename);
+        }
+
+        SkipLine(p, end);
+    }
+
+    return materials;
+}
+
+ModelData ParseObj(std::string_view text, const std::string& directoryPath, const ObjLoadOptions& options) {
+    // 行の境界で分割し、チャンクごとに並列で解析する
+    uint32_t numThreads = options.numThreads != 0 ? options.numThreads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string_view> ranges = SplitLines(text, std::min<size_t>(numThreads, text.size() / kMinChunkSize + 1));
+    std::vector<ObjChunk> chunks(ranges.size());
+    ParallelFor(chunks.size(), [&](size_t i) { ParseObjChunk(ranges[i], chunks[i]); });
+
+    // 前のチャンクまでの要素数の累積和。各チャンクの結果をどこへ書き込むかが決まる
+    std::vector<ObjChunkOffset> offsets(chunks.size() + 1);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        offsets[i + 1].position = offsets[i].position + chunks[i].positions.size();
+        offsets[i + 1].texcoord = offsets[i].texcoord + chunks[i].texcoords.size();
+        offsets[i + 1].normal = offsets[i].normal + chunks[i].normals.size();
+    }
+
+    // 要素をファイル全体の配列へまとめる
+    std::vector<Vector4> positions(offsets.back().position); // 位置
+    std::vector<Vector2> texcoords(offsets.back().texcoord); // テクスチャ座標
+    std::vector<Vector3> normals(offsets.back().normal); // 法線
+    ParallelFor(chunks.size(), [&](size_t i) {
+        std::copy(chunks[i].positions.begin(), chunks[i].positions.end(), positions.begin() + offsets[i].position);
+        std::copy(chunks[i].texcoords.begin(), chunks[i].texcoords.end(), texcoords.begin() + offsets[i].texcoord);
+        std::copy(chunks[i].normals.begin(), chunks[i].normals.end(), normals.begin() + offsets[i].normal);
+        // 相対参照だったIndexを通し番号にする。先頭の要素より前を指していれば-1にして不正なIndexとする
+        const size_t elementOffsets[3] = { offsets[i].position, offsets[i].texcoord, offsets[i].normal };
+        for (size_t face : chunks[i].relativeFaces) {
+            chunks[i].faces[face] += int32_t(elementOffsets[face % 3]);
+            if (chunks[i].faces[face] < 1) {
+                chunks[i].faces[face] = -1;
+            }
+        }
+    });
+
+    // 凹んだ多角形を分割し直す。位置がそろっている必要があるので、まとめた後に行う
+    ParallelFor(chunks.size(), [&](size_t i) {
+        std::vector<ObjFaceVertex> polygon;
+        std::vector<float> points;
+        std::vector<uint32_t> remaining;
+        for (const ObjPolygon& objPolygon : chunks[i].polygons) {
+            TriangulatePolygon(&chunks[i].faces[objPolygon.triangleBegin * 9], objPolygon.vertexCount, positions, polygon, points, remaining);
+        }
+
+        // 範囲外のIndex（0や読めない番号、先頭より前を指す相対参照、要素数を超える番号）を含む三角形は取り除く
+        // 位置は1以上が必要で、UVと法線は0なら省略
+        const size_t counts[3] = { positions.size(), texcoords.size(), normals.size() };
+        auto isValidFace = [&](const int32_t* face) {
+            for (size_t element = 0; element < 9; element++) {
+                const int32_t index = face[element];
+                if (index < (element % 3 == 0 ? 1 : 0) || size_t(index) > counts[element % 3]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::vector<int32_t>& faces = chunks[i].faces;
+        size_t writeTriangle = 0;
+        for (ObjRun& run : chunks[i].runs) {
+            const size_t runBegin = writeTriangle;
+            for (size_t triangle = run.triangleBegin; triangle < run.triangleEnd; triangle++) {
+                if (!isValidFace(&faces[triangle * 9])) {
+                    continue;
+                }
+                if (writeTriangle != triangle) {
+                    std::copy(faces.begin() + triangle * 9, faces.begin() + triangle * 9 + 9, faces.begin() + writeTriangle * 9);
+                }
+                writeTriangle++;
+            }
+            run.triangleBegin = runBegin;
+            run.triangleEnd = writeTriangle;
+        }
+        faces.resize(writeTriangle * 9);
+    });
+    for (size_t i = 0; i < chunks.size(); i++) {
+        offsets[i + 1].triangle = offsets[i].triangle + chunks[i].faces.size() / 9;
+    }
+
+    ModelData modelData; // 構築するModelData
+
+    // mtllibは出てきた順にすべて読む。同じ名前のマテリアルは先に読んだものを使う
+    for (const ObjChunk& chunk : chunks) {
+        for (std::string_view materialFilename : chunk.materialFilenames) {
+            // 基本的にobjファイルと同一階層にmtlは存在させるので、ディレクトリ名とファイル名を渡す
+            for (MaterialData& material : LoadMaterialTemplateFile(directoryPath, std::string(materialFilename))) {
+                modelData.materials.push_back(std::move(material));
+            }
+        }
+    }
+    auto findMaterial = [&](std::string_view materialName) {
+        // usemtlがなければ最初のマテリアル
+        if (materialName.empty() && !modelData.materials.empty()) {
+            return uint32_t(0);
+        }
+        for (uint32_t i = 0; i < uint32_t(modelData.materials.size()); i++) {
+            if (modelData.materials[i].name == materialName) {
+                return i;
+            }
+        }
+        // mtlにないマテリアルはテクスチャなしで追加する
+        MaterialData materialData;
+        materialData.name = materialName;
+        modelData.materials.push_back(materialData);
+        return uint32_t(modelData.materials.size() - 1);
+    };
+
+    // 並びの名前を前から順に確定させ、オブジェクト名とマテリアル名の組ごとにまとめる
+    std::vector<ObjGroup> groups;
+    std::map<std::pair<std::string_view, std::string_view>, uint32_t> groupIndices; // 組からgroupsの番号を引く
+    std::vector<std::vector<uint32_t>> runGroups(chunks.size()); // 並びごとのgroupsの番号
+    std::string_view objectName;
+    std::string_view materialName;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        for (const ObjRun& run : chunks[i].runs) {
+            objectName = run.hasObjectName ? run.objectName : objectName;
+            materialName = run.hasMaterialName ? run.materialName : materialName;
+            auto [it, isNew] = groupIndices.try_emplace({ objectName, materialName }, uint32_t(groups.size()));
+            if (isNew) {
+                groups.push_back({ objectName, materialName, 0, 0 });
+            }
+            const uint32_t group = it->second;
+            groups[group].triangleCount += run.triangleEnd - run.triangleBegin;
+            runGroups[i].push_back(group);
+        }
+    }
+
+    // 空の組を除き、同じテクスチャが並ぶように整列する
+    std::vector<uint32_t> order;
+    for (uint32_t group = 0; group < groups.size(); group++) {
+        if (groups[group].triangleCount != 0) {
+            groups[group].materialIndex = findMaterial(groups[group].materialName);
+            order.push_back(group);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const MaterialData& materialA = modelData.materials[groups[a].materialIndex];
+        const MaterialData& materialB = modelData.materials[groups[b].materialIndex];
+        if (materialA.textureFilePath != materialB.textureFilePath) {
+            return materialA.textureFilePath < materialB.textureFilePath;
+        }
+        if (materialA.name != materialB.name) {
+            return materialA.name < materialB.name;
+        }
+        return groups[a].objectName < groups[b].objectName;
+    });
+
+    // サブメッシュの範囲を決め、各並びの書き込み先を前から詰めていく
+    std::vector<size_t> cursors(groups.size());
+    size_t triangleOffset = 0;
+    for (uint32_t group : order) {
+        modelData.submeshes.push_back({ std::string(groups[group].objectName), uint32_t(triangleOffset * 3), uint32_t(groups[group].triangleCount * 3), groups[group].materialIndex });
+        cursors[group] = triangleOffset;
+        triangleOffset += groups[group].triangleCount;
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        for (size_t run = 0; run < chunks[i].runs.size(); run++) {
+            ObjRun& objRun = chunks[i].runs[run];
+            objRun.destination = cursors[runGroups[i][run]];
+            cursors[runGroups[i][run]] += objRun.triangleEnd - objRun.triangleBegin;
+        }
+    }
+
+    // 互換のため、先頭のサブメッシュのマテリアルをmaterialにも入れる
+    if (!modelData.submeshes.empty()) {
+        modelData.material = modelData.materials[modelData.submeshes.front().materialIndex];
+    } else if (!modelData.materials.empty()) {
+        modelData.material = modelData.materials.front();
+    }
+
+    // 面のIndexはファイル全体での通し番号なので、まとめた配列から頂点を構築する
+    auto makeVertex = [&](const int32_t* elementIndices) {
+        // 要素へのIndexから、実際の要素の値を取得して、頂点を構築する
+        // UVと法線は省略できるので、なければ0にする。範囲外のIndexを含む三角形は取り除いてある
+        assert(elementIndices[0] >= 1 && size_t(elementIndices[0]) <= positions.size());
+        assert(elementIndices[1] >= 0 && size_t(elementIndices[1]) <= texcoords.size());
+        assert(elementIndices[2] >= 0 && size_t(elementIndices[2]) <= normals.size());
+        VertexData vertex = { positions[elementIndices[0] - 1], { 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+        if (elementIndices[1] != 0) {
+            vertex.texcoord = texcoords[elementIndices[1] - 1];
+        }
+        if (elementIndices[2] != 0) {
+            vertex.normal = normals[elementIndices[2] - 1];
+        }
+        return vertex;
+    };
+
+    // 法線が省略された頂点の印。法線を作るときにその頂点だけを書き換える
+    std::vector<uint8_t> missingNormals;
+    if (options.indexed) {
+        // 「位置/UV/法線」の組が同じ頂点は1つにまとめる。番号はファイルで最初に出てきた順に振る
+        // まずチャンクごとに並列でまとめ、チャンク内の番号を振る
+        struct ChunkVertices {
+            std::vector<uint32_t> indices; // 面の頂点ごとのチャンク内の番号（面を読む順）
+            std::vector<uint32_t> uniqueFaces; // チャンク内の番号ごとの、facesでの組の位置
+            std::vector<uint32_t> remap; // チャンク内の番号から通し番号
+            std::vector<uint32_t> newVertices; // このチャンクで初めて出てきた組のチャンク内の番号
+        };
+        std::vector<ChunkVertices> chunkVertices(chunks.size());
+        ParallelFor(chunks.size(), [&](size_t i) {
+            const std::vector<int32_t>& faces = chunks[i].faces;
+            ChunkVertices& local = chunkVertices[i];
+            VertexIndexTable table;
+            local.indices.reserve(faces.size() / 3);
+            for (const ObjRun& run : chunks[i].runs) {
+                for (size_t face = run.triangleBegin * 9; face < run.triangleEnd * 9; face += 9) {
+                    // 頂点を逆順で登録することで、周り順を逆にする
+                    for (size_t faceVertex = 3; faceVertex-- > 0;) {
+                        const int32_t* elementIndices = &faces[face + faceVertex * 3];
+                        const uint32_t newIndex = uint32_t(local.uniqueFaces.size());
+                        const uint32_t index = table.FindOrInsert(elementIndices, newIndex);
+                        if (index == newIndex) {
+                            local.uniqueFaces.push_back(uint32_t(face + faceVertex * 3));
+                        }
+                        local.indices.push_back(index);
+                    }
+                }
+            }
+        });
+
+        // チャンクの順に、まとめた組だけを通しの表へ入れる。前のチャンクにあった組はその番号を使う
+        // チャンクごとの新しい頂点の数の累積和が、そのチャンクの頂点の書き込み先になる
+        std::vector<uint32_t> vertexOffsets(chunks.size() + 1, 0);
+        if (chunks.size() == 1) {
+            ChunkVertices& local = chunkVertices[0];
+            local.remap.resize(local.uniqueFaces.size());
+            local.newVertices.resize(local.uniqueFaces.size());
+            for (uint32_t index = 0; index < local.uniqueFaces.size(); index++) {
+                local.remap[index] = index;
+                local.newVertices[index] = index;
+            }
+            vertexOffsets[1] = uint32_t(local.uniqueFaces.size());
+        } else {
+            VertexIndexTable table;
+            for (size_t i = 0; i < chunks.size(); i++) {
+                ChunkVertices& local = chunkVertices[i];
+                local.remap.resize(local.uniqueFaces.size());
+                for (uint32_t index = 0; index < local.uniqueFaces.size(); index++) {
+                    const uint32_t newIndex = vertexOffsets[i] + uint32_t(local.newVertices.size());
+                    local.remap[index] = table.FindOrInsert(&chunks[i].faces[local.uniqueFaces[index]], newIndex);
+                    if (local.remap[index] == newIndex) {
+                        local.newVertices.push_back(index);
+                    }
+                }
+                vertexOffsets[i + 1] = vertexOffsets[i] + uint32_t(local.newVertices.size());
+            }
+        }
+
+        // 頂点の構築とIndexの書き込みはチャンクごとに並列で行う
+        modelData.verticles.resize(vertexOffsets.back());
+        missingNormals.resize(vertexOffsets.back());
+        modelData.indices.resize(offsets.back().triangle * 3);
+        ParallelFor(chunks.size(), [&](size_t i) {
+            const ChunkVertices& local = chunkVertices[i];
+            for (size_t k = 0; k < local.newVertices.size(); k++) {
+                const int32_t* elementIndices = &chunks[i].faces[local.uniqueFaces[local.newVertices[k]]];
+                modelData.verticles[vertexOffsets[i] + k] = makeVertex(elementIndices);
+                missingNormals[vertexOffsets[i] + k] = elementIndices[2] == 0;
+            }
+            const uint32_t* in = local.indices.data();
+            for (const ObjRun& run : chunks[i].runs) {
+                uint32_t* out = modelData.indices.data() + run.destination * 3;
+                for (size_t corner = 0; corner < (run.triangleEnd - run.triangleBegin) * 3; corner++) {
+                    *out++ = local.remap[*in++];
+                }
+            }
+        });
+    } else {
+        modelData.verticles.resize(offsets.back().triangle * 3);
+        missingNormals.resize(modelData.verticles.size());
+        ParallelFor(chunks.size(), [&](size_t i) {
+            const std::vector<int32_t>& faces = chunks[i].faces;
+            for (const ObjRun& run : chunks[i].runs) {
+                VertexData* out = modelData.verticles.data() + run.destination * 3;
+                uint8_t* outMissing = missingNormals.data() + run.destination * 3;
+                for (size_t face = run.triangleBegin * 9; face < run.triangleEnd * 9; face += 9) {
+                    // 頂点を逆順で登録することで、周り順を逆にする
+                    for (size_t faceVertex = 3; faceVertex-- > 0;) {
+                        *out++ = makeVertex(&faces[face + faceVertex * 3]);
+                        *outMissing++ = faces[face + faceVertex * 3 + 2] == 0;
+                    }
+                }
+            }
+        });
+    }
+
+    // 法線が省略された頂点があれば、面の向きから滑らかな法線を作る。ファイルにある法線はそのまま使う
+    if (std::find(missingNormals.begin(), missingNormals.end(), uint8_t(1)) != missingNormals.end()) {
+        GenerateNormals(modelData, numThreads, missingNormals);
+    }
+    if (options.generateTangents) {
+        GenerateTangents(modelData, numThreads);
+    }
+    ComputeModelBounds(modelData);
+
+    return modelData;
+}
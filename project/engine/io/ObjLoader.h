@@ -0,0 +1,31 @@
+#pragma once
+#include "engine/3d/ModelData.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// objの読み込み設定
+struct ObjLoadOptions {
+	// 解析に使うスレッド数。0ならハードウェアのスレッド数
+	// 大きなファイルは行の境界で分割して並列に解析する（結果は1スレッドの場合と同じ）
+	uint32_t numThreads = 1;
+	// trueなら同じ頂点を1つにまとめ、indicesを出力する
+	bool indexed = false;
+	// trueならUVから接線を作り、tangentsに入れる
+	bool generateTangents = false;
+};
+
+// mtlファイルを読み込む。newmtlごとに1つのMaterialDataになる
+std::vector<MaterialData> LoadMaterialTemplateFile(const std::string& directoryPath, const std::string& filename);
+
+// objファイルを読み込む。メッシュ全体とサブメッシュの境界も求める
+ModelData LoadObjFile(const std::string& directoryPath, const std::string& filename, const ObjLoadOptions& options = {});
+
+// メモリ上のobjテキストを解析する。mtllibはdirectoryPathから読み込む
+// 面はo/gの名前とusemtlのマテリアルの組ごとにサブメッシュにまとめる
+// 範囲外の要素を指す面（多角形なら分割後の三角形）は読み飛ばす
+ModelData ParseObj(std::string_view text, const std::string& directoryPath, const ObjLoadOptions& options = {});
+
+// メモリ上のmtlテキストを解析する
+std::vector<MaterialData> ParseMaterialTemplate(std::string_view text, const std::string& directoryPath);
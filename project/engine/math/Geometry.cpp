@@ -0,0 +1,221 @@
+#include "Geometry.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+    // 行列のj列目 (a, b, c, d) から平面を作る。a*x + b*y + c*z + d >= 0 が内側
+    Plane MakePlane(float a, float b, float c, float d) {
+        float invLength = 1.0f / std::sqrt(a * a + b * b + c * c);
+        return { { a * invLength, b * invLength, c * invLength }, -d * invLength };
+    }
+
+    // 球1つ分の判定
+    bool IsVisibleSphere(const Frustum& frustum, float x, float y, float z, float radius) {
+        for (const Plane& plane : frustum.planes) {
+            if (plane.normal.x * x + plane.normal.y * y + plane.normal.z * z - plane.distance < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// ビュープロジェクション行列から視錐台を作る
+Frustum MakeFrustum(const Matrix4x4& viewProjection) {
+    const Matrix4x4& m = viewProjection;
+    // 行ベクトルに右から掛けるので、クリップ座標の各成分は行列の列との内積になる
+    auto column = [&m](int j, int k) { return m.m[k][j]; };
+
+    Frustum frustum;
+    float c0[4], c1[4], c2[4], c3[4];
+    for (int k = 0; k < 4; k++) {
+        c0[k] = column(0, k);
+        c1[k] = column(1, k);
+        c2[k] = column(2, k);
+        c3[k] = column(3, k);
+    }
+    // -w <= x <= w, -w <= y <= w, 0 <= z <= w
+    frustum.planes[0] = MakePlane(c3[0] + c0[0], c3[1] + c0[1], c3[2] + c0[2], c3[3] + c0[3]);
+    frustum.planes[1] = MakePlane(c3[0] - c0[0], c3[1] - c0[1], c3[2] - c0[2], c3[3] - c0[3]);
+    frustum.planes[2] = MakePlane(c3[0] + c1[0], c3[1] + c1[1], c3[2] + c1[2], c3[3] + c1[3]);
+    frustum.planes[3] = MakePlane(c3[0] - c1[0], c3[1] - c1[1], c3[2] - c1[2], c3[3] - c1[3]);
+    frustum.planes[4] = MakePlane(c2[0], c2[1], c2[2], c2[3]);
+    frustum.planes[5] = MakePlane(c3[0] - c2[0], c3[1] - c2[1], c3[2] - c2[2], c3[3] - c2[3]);
+
+    return frustum;
+}
+
+// 点と平面の符号付き距離
+float SignedDistance(const Plane& plane, const Vector3& point) {
+    return Dot(plane.normal, point) - plane.distance;
+}
+
+// 点群を囲む球を作る（Ritterの方法）
+Sphere MakeBoundingSphere(std::span<const Vector3> points) {
+    if (points.empty()) {
+        return { { 0.0f, 0.0f, 0.0f }, 0.0f };
+    }
+
+    // 各軸で一番離れた2点のうち、一番遠い組を初期の直径にする
+    auto component = [](const Vector3& v, int axis) { return axis == 0 ? v.x : (axis == 1 ? v.y : v.z); };
+    size_t minIndex[3] = {}, maxIndex[3] = {};
+    for (size_t i = 0; i < points.size(); i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            if (component(points[i], axis) < component(points[minIndex[axis]], axis)) {
+                minIndex[axis] = i;
+            }
+            if (component(points[i], axis) > component(points[maxIndex[axis]], axis)) {
+                maxIndex[axis] = i;
+            }
+        }
+    }
+    int bestAxis = 0;
+    float bestDistance = -1.0f;
+    for (int axis = 0; axis < 3; axis++) {
+        const float distance = LengthSquared(points[maxIndex[axis]] - points[minIndex[axis]]);
+        if (distance > bestDistance) {
+            bestDistance = distance;
+            bestAxis = axis;
+        }
+    }
+    Vector3 center = (points[minIndex[bestAxis]] + points[maxIndex[bestAxis]]) * 0.5f;
+    float radius = std::sqrt(bestDistance) * 0.5f;
+
+    // 外にある点を含むように球を広げる
+    for (const Vector3& point : points) {
+        const float distance = Length(point - center);
+        if (distance > radius) {
+            const float newRadius = (radius + distance) * 0.5f;
+            center = center + (point - center) * ((newRadius - radius) / distance);
+            radius = newRadius;
+        }
+    }
+
+    // 平たい形では境界箱の中心を使う方が小さくなることがあるので、小さい方を選ぶ
+    const Vector3 boxCenter = {
+        (points[minIndex[0]].x + points[maxIndex[0]].x) * 0.5f,
+        (points[minIndex[1]].y + points[maxIndex[1]].y) * 0.5f,
+        (points[minIndex[2]].z + points[maxIndex[2]].z) * 0.5f,
+    };
+    float boxRadiusSquared = 0.0f;
+    for (const Vector3& point : points) {
+        boxRadiusSquared = std::max(boxRadiusSquared, LengthSquared(point - boxCenter));
+    }
+    const float boxRadius = std::sqrt(boxRadiusSquared);
+    if (boxRadius < radius) {
+        return { boxCenter, boxRadius };
+    }
+    return { center, radius };
+}
+
+bool IsCollision(const AABB& aabb1, const AABB& aabb2) {
+    return (aabb1.min.x <= aabb2.max.x && aabb1.max.x >= aabb2.min.x) &&
+        (aabb1.min.y <= aabb2.max.y && aabb1.max.y >= aabb2.min.y) &&
+        (aabb1.min.z <= aabb2.max.z && aabb1.max.z >= aabb2.min.z);
+}
+
+bool IsCollision(const Sphere& sphere1, const Sphere& sphere2) {
+    float radius = sphere1.radius + sphere2.radius;
+    return LengthSquared(sphere2.center - sphere1.center) <= radius * radius;
+}
+
+bool IsCollision(const AABB& aabb, const Sphere& sphere) {
+    // 球の中心に一番近いAABB上の点
+    Vector3 closestPoint = {
+        std::clamp(sphere.center.x, aabb.min.x, aabb.max.x),
+        std::clamp(sphere.center.y, aabb.min.y, aabb.max.y),
+        std::clamp(sphere.center.z, aabb.min.z, aabb.max.z),
+    };
+    return LengthSquared(closestPoint - sphere.center) <= sphere.radius * sphere.radius;
+}
+
+bool IsVisible(const Frustum& frustum, const Sphere& sphere) {
+    return IsVisibleSphere(frustum, sphere.center.x, sphere.center.y, sphere.center.z, sphere.radius);
+}
+
+bool IsVisible(const Frustum& frustum, const AABB& aabb) {
+    for (const Plane& plane : frustum.planes) {
+        // 法線方向に一番遠い頂点が外側なら全体が外側
+        Vector3 positive = {
+            plane.normal.x >= 0.0f ? aabb.max.x : aabb.min.x,
+            plane.normal.y >= 0.0f ? aabb.max.y : aabb.min.y,
+            plane.normal.z >= 0.0f ? aabb.max.z : aabb.min.z,
+        };
+        if (SignedDistance(plane, positive) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 複数の球をまとめて視錐台カリングする
+void CullSpheres(const Frustum& frustum, std::span<const float> centerX, std::span<const float> centerY, std::span<const float> centerZ,
+    std::span<const float> radii, std::span<uint8_t> outVisible) {
+    const size_t count = outVisible.size();
+    assert(centerX.size() == count && centerY.size() == count && centerZ.size() == count && radii.size() == count);
+
+    size_t index = 0;
+
+#if defined(MATH_USE_AVX2)
+    // 8個ずつ判定する
+    __m256 normalX[6], normalY[6], normalZ[6], distance[6];
+    for (int p = 0; p < 6; p++) {
+        normalX[p] = _mm256_set1_ps(frustum.planes[p].normal.x);
+        normalY[p] = _mm256_set1_ps(frustum.planes[p].normal.y);
+        normalZ[p] = _mm256_set1_ps(frustum.planes[p].normal.z);
+        distance[p] = _mm256_set1_ps(frustum.planes[p].distance);
+    }
+    for (; index + 8 <= count; index += 8) {
+        const __m256 x = _mm256_loadu_ps(&centerX[index]);
+        const __m256 y = _mm256_loadu_ps(&centerY[index]);
+        const __m256 z = _mm256_loadu_ps(&centerZ[index]);
+        const __m256 r = _mm256_loadu_ps(&radii[index]);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            // Dot(n, c) - d + r >= 0 なら平面の内側
+            __m256 d = _mm256_fmadd_ps(normalX[p], x, _mm256_sub_ps(r, distance[p]));
+            d = _mm256_fmadd_ps(normalY[p], y, d);
+            d = _mm256_fmadd_ps(normalZ[p], z, d);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        const int mask = _mm256_movemask_ps(visible);
+        for (int i = 0; i < 8; i++) {
+            outVisible[index + i] = uint8_t((mask >> i) & 1);
+        }
+    }
+#elif defined(MATH_USE_SSE)
+    // 4個ずつ判定する
+    __m128 normalX[6], normalY[6], normalZ[6], distance[6];
+    for (int p = 0; p < 6; p++) {
+        normalX[p] = _mm_set1_ps(frustum.planes[p].normal.x);
+        normalY[p] = _mm_set1_ps(frustum.planes[p].normal.y);
+        normalZ[p] = _mm_set1_ps(frustum.planes[p].normal.z);
+        distance[p] = _mm_set1_ps(frustum.planes[p].distance);
+    }
+    for (; index + 4 <= count; index += 4) {
+        const __m128 x = _mm_loadu_ps(&centerX[index]);
+        const __m128 y = _mm_loadu_ps(&centerY[index]);
+        const __m128 z = _mm_loadu_ps(&centerZ[index]);
+        const __m128 r = _mm_loadu_ps(&radii[index]);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            // Dot(n, c) - d + r >= 0 なら平面の内側
+            __m128 d = _mm_add_ps(_mm_mul_ps(normalX[p], x), _mm_sub_ps(r, distance[p]));
+            d = _mm_add_ps(_mm_mul_ps(normalY[p], y), d);
+            d = _mm_add_ps(_mm_mul_ps(normalZ[p], z), d);
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(d, _mm_setzero_ps()));
+        }
+        const int mask = _mm_movemask_ps(visible);
+        for (int i = 0; i < 4; i++) {
+            outVisible[index + i] = uint8_t((mask >> i) & 1);
+        }
+    }
+#endif
+
+    // 端数は1つずつ判定する
+    for (; index < count; index++) {
+        outVisible[index] = IsVisibleSphere(frustum, centerX[index], centerY[index], centerZ[index], radii[index]) ? 1 : 0;
+    }
+}
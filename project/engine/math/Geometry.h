@@ -0,0 +1,52 @@
+#pragma once
+#include "Matrix.h"
+#include <cstdint>
+#include <span>
+
+// 軸平行境界箱
+struct AABB {
+	Vector3 min;
+	Vector3 max;
+};
+
+// 球
+struct Sphere {
+	Vector3 center;
+	float radius;
+};
+
+// 平面。平面上の点pは Dot(normal, p) == distance を満たす
+struct Plane {
+	Vector3 normal;
+	float distance;
+};
+
+// 視錐台。各平面の法線は内側を向いている
+struct Frustum {
+	// 0:左 1:右 2:下 3:上 4:近 5:遠
+	Plane planes[6];
+};
+
+// ビュープロジェクション行列から視錐台を作る（深度は0～1）
+Frustum MakeFrustum(const Matrix4x4& viewProjection);
+
+// 点と平面の符号付き距離。法線側が正
+float SignedDistance(const Plane& plane, const Vector3& point);
+
+// 点群を囲む球を作る（Ritterの方法）。境界箱の中心を使った球の方が小さければそちらを返す
+// 最小の球よりいくらか大きくなることがある
+Sphere MakeBoundingSphere(std::span<const Vector3> points);
+
+// 衝突判定
+bool IsCollision(const AABB& aabb1, const AABB& aabb2);
+bool IsCollision(const Sphere& sphere1, const Sphere& sphere2);
+bool IsCollision(const AABB& aabb, const Sphere& sphere);
+
+// 視錐台の中に一部でも入っているか
+bool IsVisible(const Frustum& frustum, const Sphere& sphere);
+bool IsVisible(const Frustum& frustum, const AABB& aabb);
+
+// 複数の球をまとめて視錐台カリングする
+// 中心は成分ごとの配列で渡す。outVisible[i]に見えていれば1、そうでなければ0を書き込む
+void CullSpheres(const Frustum& frustum, std::span<const float> centerX, std::span<const float> centerY, std::span<const float> centerZ,
+	std::span<const float> radii, std::span<uint8_t> outVisible);
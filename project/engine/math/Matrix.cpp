@@ -1,55 +1,109 @@
 #include "Matrix.h"
+#include "Simd.h"
 #include <cmath>
 
-const Vector3 operator+(const Vector3& v1, const Vector3& v2) {
-    Vector3 temp(v1);
-    return temp += v2;
-}
-
-const Vector3 operator*(const Vector3& v1, const float f) {
-    Vector3 temp(v1);
-    return temp *= f;
-}
-
-Vector3& operator+=(Vector3& lhv, const Vector3& rhv) {
-    lhv.x += rhv.x;
-    lhv.y += rhv.y;
-    lhv.z += rhv.z;
-    return lhv;
-}
+namespace {
+#ifndef MATH_USE_SSE
+    // 行列の積（スカラー版）
+    void MultiplyMatrixScalar(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& out) {
+        Matrix4x4 result = {};
 
-Vector3& operator-=(Vector3& lhv, const Vector3& rhv) {
-    lhv.x -= rhv.x;
-    lhv.y -= rhv.y;
-    lhv.z -= rhv.z;
-    return lhv;
-}
+        result.m[0][0] = m1.m[0][0] * m2.m[0][0] + m1.m[0][1] * m2.m[1][0] + m1.m[0][2] * m2.m[2][0] + m1.m[0][3] * m2.m[3][0]; result.m[0][1] = m1.m[0][0] * m2.m[0][1] + m1.m[0][1] * m2.m[1][1] + m1.m[0][2] * m2.m[2][1] + m1.m[0][3] * m2.m[3][1]; result.m[0][2] = m1.m[0][0] * m2.m[0][2] + m1.m[0][1] * m2.m[1][2] + m1.m[0][2] * m2.m[2][2] + m1.m[0][3] * m2.m[3][2]; result.m[0][3] = m1.m[0][0] * m2.m[0][3] + m1.m[0][1] * m2.m[1][3] + m1.m[0][2] * m2.m[2][3] + m1.m[0][3] * m2.m[3][3];
+        result.m[1][0] = m1.m[1][0] * m2.m[0][0] + m1.m[1][1] * m2.m[1][0] + m1.m[1][2] * m2.m[2][0] + m1.m[1][3] * m2.m[3][0]; result.m[1][1] = m1.m[1][0] * m2.m[0][1] + m1.m[1][1] * m2.m[1][1] + m1.m[1][2] * m2.m[2][1] + m1.m[1][3] * m2.m[3][1]; result.m[1][2] = m1.m[1][0] * m2.m[0][2] + m1.m[1][1] * m2.m[1][2] + m1.m[1][2] * m2.m[2][2] + m1.m[1][3] * m2.m[3][2]; result.m[1][3] = m1.m[1][0] * m2.m[0][3] + m1.m[1][1] * m2.m[1][3] + m1.m[1][2] * m2.m[2][3] + m1.m[1][3] * m2.m[3][3];
+        result.m[2][0] = m1.m[2][0] * m2.m[0][0] + m1.m[2][1] * m2.m[1][0] + m1.m[2][2] * m2.m[2][0] + m1.m[2][3] * m2.m[3][0]; result.m[2][1] = m1.m[2][0] * m2.m[0][1] + m1.m[2][1] * m2.m[1][1] + m1.m[2][2] * m2.m[2][1] + m1.m[2][3] * m2.m[3][1]; result.m[2][2] = m1.m[2][0] * m2.m[0][2] + m1.m[2][1] * m2.m[1][2] + m1.m[2][2] * m2.m[2][2] + m1.m[2][3] * m2.m[3][2]; result.m[2][3] = m1.m[2][0] * m2.m[0][3] + m1.m[2][1] * m2.m[1][3] + m1.m[2][2] * m2.m[2][3] + m1.m[2][3] * m2.m[3][3];
+        result.m[3][0] = m1.m[3][0] * m2.m[0][0] + m1.m[3][1] * m2.m[1][0] + m1.m[3][2] * m2.m[2][0] + m1.m[3][3] * m2.m[3][0]; result.m[3][1] = m1.m[3][0] * m2.m[0][1] + m1.m[3][1] * m2.m[1][1] + m1.m[3][2] * m2.m[2][1] + m1.m[3][3] * m2.m[3][1]; result.m[3][2] = m1.m[3][0] * m2.m[0][2] + m1.m[3][1] * m2.m[1][2] + m1.m[3][2] * m2.m[2][2] + m1.m[3][3] * m2.m[3][2]; result.m[3][3] = m1.m[3][0] * m2.m[0][3] + m1.m[3][1] * m2.m[1][3] + m1.m[3][2] * m2.m[2][3] + m1.m[3][3] * m2.m[3][3];
 
-Vector3& operator*=(Vector3& v, float s) {
-    v.x *= s;
-    v.y *= s;
-    v.z *= s;
-    return v;
-}
+        out = result;
+    }
+#endif
+
+#ifdef MATH_USE_SSE
+    // 行ベクトル1本と行列の積。b[]は右側の行列の各行
+    inline __m128 MultiplyRow(__m128 row, const __m128 b[4]) {
+        __m128 result = _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b[0]);
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b[1]));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b[2]));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), b[3]));
+        return result;
+    }
+#endif
+
+#ifdef MATH_USE_AVX2
+    // 行ベクトル2本をまとめて計算する。b[]は右側の行列の各行を上下のレーンに複製したもの
+    inline __m256 MultiplyRow2(__m256 rows, const __m256 b[4]) {
+        __m256 result = _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b[0]);
+        result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b[1], result);
+        result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b[2], result);
+        result = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b[3], result);
+        return result;
+    }
+#endif
 
-Vector3& operator/=(Vector3& v, float s) {
-    v.x /= s;
-    v.y /= s;
-    v.z /= s;
-    return v;
-}
+    // 右側の行列を読み込んでおく
+    struct MultiplyOperand {
+#if defined(MATH_USE_AVX2)
+        __m256 rows[4];
 
-Matrix4x4& operator*=(Matrix4x4& lhm, const Matrix4x4& rhm) {
-    Matrix4x4 result{};
+        explicit MultiplyOperand(const Matrix4x4& m) {
+            for (int i = 0; i < 4; i++) {
+                __m128 row = _mm_loadu_ps(m.m[i]);
+                rows[i] = _mm256_insertf128_ps(_mm256_castps128_ps256(row), row, 1);
+            }
+        }
+#elif defined(MATH_USE_SSE)
+        __m128 rows[4];
 
-    for (size_t i = 0; i < 4; i++) {
-        for (size_t j = 0; j < 4; j++) {
-            for (size_t k = 0; k < 4; k++) {
-                result.m[i][j] += lhm.m[i][k] * rhm.m[k][j];
+        explicit MultiplyOperand(const Matrix4x4& m) {
+            for (int i = 0; i < 4; i++) {
+                rows[i] = _mm_loadu_ps(m.m[i]);
             }
         }
+#else
+        Matrix4x4 matrix;
+
+        explicit MultiplyOperand(const Matrix4x4& m) : matrix(m) {}
+#endif
+    };
+
+    // 行列の積の本体。resultはm1と同じ行列でもよい
+    inline void MultiplyMatrix(const Matrix4x4& m1, const MultiplyOperand& m2, Matrix4x4& result) {
+#if defined(MATH_USE_AVX2)
+        __m256 row01 = MultiplyRow2(_mm256_loadu_ps(m1.m[0]), m2.rows);
+        __m256 row23 = MultiplyRow2(_mm256_loadu_ps(m1.m[2]), m2.rows);
+        _mm256_storeu_ps(result.m[0], row01);
+        _mm256_storeu_ps(result.m[2], row23);
+#elif defined(MATH_USE_SSE)
+        __m128 row0 = MultiplyRow(_mm_loadu_ps(m1.m[0]), m2.rows);
+        __m128 row1 = MultiplyRow(_mm_loadu_ps(m1.m[1]), m2.rows);
+        __m128 row2 = MultiplyRow(_mm_loadu_ps(m1.m[2]), m2.rows);
+        __m128 row3 = MultiplyRow(_mm_loadu_ps(m1.m[3]), m2.rows);
+        _mm_storeu_ps(result.m[0], row0);
+        _mm_storeu_ps(result.m[1], row1);
+        _mm_storeu_ps(result.m[2], row2);
+        _mm_storeu_ps(result.m[3], row3);
+#else
+        MultiplyMatrixScalar(m1, m2.matrix, result);
+#endif
+    }
+
+    inline void MultiplyMatrix(const Matrix4x4& m1, const Matrix4x4& m2, Matrix4x4& result) {
+        MultiplyMatrix(m1, MultiplyOperand(m2), result);
+    }
+
+    // X→Y→Z軸回転を合成した3x3の回転行列を直接作る。sin/cosは各軸1回ずつ
+    inline void MakeRotateXYZ(const Vector3& rotate, float r[3][3]) {
+        const float sx = std::sin(rotate.x), cx = std::cos(rotate.x);
+        const float sy = std::sin(rotate.y), cy = std::cos(rotate.y);
+        const float sz = std::sin(rotate.z), cz = std::cos(rotate.z);
+
+        r[0][0] = cy * cz;                r[0][1] = cy * sz;                r[0][2] = -sy;
+        r[1][0] = sx * sy * cz - cx * sz; r[1][1] = sx * sy * sz + cx * cz; r[1][2] = sx * cy;
+        r[2][0] = cx * sy * cz + sx * sz; r[2][1] = cx * sy * sz - sx * cz; r[2][2] = cx * cy;
     }
-    lhm = result;
+}
+
+Matrix4x4& operator*=(Matrix4x4& lhm, const Matrix4x4& rhm) {
+    MultiplyMatrix(lhm, rhm, lhm);
     return lhm;
 }
 
@@ -59,9 +113,6 @@ Matrix4x4 operator*(const Matrix4x4& m1, const Matrix4x4& m2) {
     return result *= m2;
 }
 
-Vector3 operator+(const Vector3& v) { return v; }
-Vector3 operator-(const Vector3& v) { return Vector3(-v.x, -v.y, -v.z); }
-
 // 単位行列の作成
 Matrix4x4 Matrix::MakeIdentity4x4() {
     Matrix4x4 result = {};
@@ -76,16 +127,20 @@ Matrix4x4 Matrix::MakeIdentity4x4() {
 
 // 行列の積
 Matrix4x4 Matrix::Multiply(const Matrix4x4& m1, const Matrix4x4& m2) {
-    Matrix4x4 result = {};
-
-    result.m[0][0] = m1.m[0][0] * m2.m[0][0] + m1.m[0][1] * m2.m[1][0] + m1.m[0][2] * m2.m[2][0] + m1.m[0][3] * m2.m[3][0]; result.m[0][1] = m1.m[0][0] * m2.m[0][1] + m1.m[0][1] * m2.m[1][1] + m1.m[0][2] * m2.m[2][1] + m1.m[0][3] * m2.m[3][1]; result.m[0][2] = m1.m[0][0] * m2.m[0][2] + m1.m[0][1] * m2.m[1][2] + m1.m[0][2] * m2.m[2][2] + m1.m[0][3] * m2.m[3][2]; result.m[0][3] = m1.m[0][0] * m2.m[0][3] + m1.m[0][1] * m2.m[1][3] + m1.m[0][2] * m2.m[2][3] + m1.m[0][3] * m2.m[3][3];
-    result.m[1][0] = m1.m[1][0] * m2.m[0][0] + m1.m[1][1] * m2.m[1][0] + m1.m[1][2] * m2.m[2][0] + m1.m[1][3] * m2.m[3][0]; result.m[1][1] = m1.m[1][0] * m2.m[0][1] + m1.m[1][1] * m2.m[1][1] + m1.m[1][2] * m2.m[2][1] + m1.m[1][3] * m2.m[3][1]; result.m[1][2] = m1.m[1][0] * m2.m[0][2] + m1.m[1][1] * m2.m[1][2] + m1.m[1][2] * m2.m[2][2] + m1.m[1][3] * m2.m[3][2]; result.m[1][3] = m1.m[1][0] * m2.m[0][3] + m1.m[1][1] * m2.m[1][3] + m1.m[1][2] * m2.m[2][3] + m1.m[1][3] * m2.m[3][3];
-    result.m[2][0] = m1.m[2][0] * m2.m[0][0] + m1.m[2][1] * m2.m[1][0] + m1.m[2][2] * m2.m[2][0] + m1.m[2][3] * m2.m[3][0]; result.m[2][1] = m1.m[2][0] * m2.m[0][1] + m1.m[2][1] * m2.m[1][1] + m1.m[2][2] * m2.m[2][1] + m1.m[2][3] * m2.m[3][1]; result.m[2][2] = m1.m[2][0] * m2.m[0][2] + m1.m[2][1] * m2.m[1][2] + m1.m[2][2] * m2.m[2][2] + m1.m[2][3] * m2.m[3][2]; result.m[2][3] = m1.m[2][0] * m2.m[0][3] + m1.m[2][1] * m2.m[1][3] + m1.m[2][2] * m2.m[2][3] + m1.m[2][3] * m2.m[3][3];
-    result.m[3][0] = m1.m[3][0] * m2.m[0][0] + m1.m[3][1] * m2.m[1][0] + m1.m[3][2] * m2.m[2][0] + m1.m[3][3] * m2.m[3][0]; result.m[3][1] = m1.m[3][0] * m2.m[0][1] + m1.m[3][1] * m2.m[1][1] + m1.m[3][2] * m2.m[2][1] + m1.m[3][3] * m2.m[3][1]; result.m[3][2] = m1.m[3][0] * m2.m[0][2] + m1.m[3][1] * m2.m[1][2] + m1.m[3][2] * m2.m[2][2] + m1.m[3][3] * m2.m[3][2]; result.m[3][3] = m1.m[3][0] * m2.m[0][3] + m1.m[3][1] * m2.m[1][3] + m1.m[3][2] * m2.m[2][3] + m1.m[3][3] * m2.m[3][3];
-
+    Matrix4x4 result;
+    MultiplyMatrix(m1, m2, result);
     return result;
 }
 
+// 複数の行列に同じ行列を右から掛ける
+void Matrix::MultiplyBatch(const Matrix4x4* m1, const Matrix4x4& m2, Matrix4x4* result, size_t count) {
+    // 右側の行列は一度だけ読み込む
+    MultiplyOperand operand(m2);
+    for (size_t i = 0; i < count; i++) {
+        MultiplyMatrix(m1[i], operand, result[i]);
+    }
+}
+
 Matrix4x4 Matrix::MakeScaleMatrix(const Vector3& scale) {
     Matrix4x4 result = {};
     result.m[0][0] = scale.x; result.m[0][1] = 0.0f;	result.m[0][2] = 0.0f;	  result.m[0][3] = 0.0f;
@@ -140,7 +195,23 @@ Matrix4x4 Matrix::MakeTranslateMatrix(const Vector3& translate) {
     return result;
 }
 
+// アフィン変換
 Matrix4x4 Matrix::MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+    // S * Rx * Ry * Rz * T を展開して直接書き込む
+    float r[3][3];
+    MakeRotateXYZ(rotate, r);
+
+    Matrix4x4 result;
+    result.m[0][0] = scale.x * r[0][0]; result.m[0][1] = scale.x * r[0][1]; result.m[0][2] = scale.x * r[0][2]; result.m[0][3] = 0.0f;
+    result.m[1][0] = scale.y * r[1][0]; result.m[1][1] = scale.y * r[1][1]; result.m[1][2] = scale.y * r[1][2]; result.m[1][3] = 0.0f;
+    result.m[2][0] = scale.z * r[2][0]; result.m[2][1] = scale.z * r[2][1]; result.m[2][2] = scale.z * r[2][2]; result.m[2][3] = 0.0f;
+    result.m[3][0] = translate.x;       result.m[3][1] = translate.y;       result.m[3][2] = translate.z;       result.m[3][3] = 1.0f;
+
+    return result;
+}
+
+// アフィン変換（行列を掛け合わせて作る参照実装）
+Matrix4x4 Matrix::MakeAffineMatrixReference(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
     // 拡大縮小行列
     Matrix4x4 scaleMatrix = MakeScaleMatrix(scale);
 
@@ -185,10 +256,10 @@ Matrix4x4 Matrix::Inverse(const Matrix4x4& m) {
     Matrix4x4 result = {};
 
     result.m[0][0] = 1.0f / A * (m.m[1][1] * m.m[2][2] * m.m[3][3] + m.m[1][2] * m.m[2][3] * m.m[3][1] + m.m[1][3] * m.m[2][1] * m.m[3][2] - m.m[1][3] * m.m[2][2] * m.m[3][1] - m.m[1][2] * m.m[2][1] * m.m[3][3] - m.m[1][1] * m.m[2][3] * m.m[3][2]);
-    result.m[0][1] = 1.0f / A * (-m.m[0][1] * m.m[2][2] * m.m[3][3] - m.m[0][1] * m.m[2][3] * m.m[3][1] - m.m[0][3] * m.m[2][1] * m.m[3][2] + m.m[0][3] * m.m[2][2] * m.m[3][1] + m.m[0][2] * m.m[2][1] * m.m[3][3] + m.m[0][1] * m.m[2][3] * m.m[3][2]);
+    result.m[0][1] = 1.0f / A * (-m.m[0][1] * m.m[2][2] * m.m[3][3] - m.m[0][2] * m.m[2][3] * m.m[3][1] - m.m[0][3] * m.m[2][1] * m.m[3][2] + m.m[0][3] * m.m[2][2] * m.m[3][1] + m.m[0][2] * m.m[2][1] * m.m[3][3] + m.m[0][1] * m.m[2][3] * m.m[3][2]);
     result.m[0][2] = 1.0f / A * (m.m[0][1] * m.m[1][2] * m.m[3][3] + m.m[0][2] * m.m[1][3] * m.m[3][1] + m.m[0][3] * m.m[1][1] * m.m[3][2] - m.m[0][3] * m.m[1][2] * m.m[3][1] - m.m[0][2] * m.m[1][1] * m.m[3][3] - m.m[0][1] * m.m[1][3] * m.m[3][2]);
     result.m[0][3] = 1.0f / A * (-m.m[0][1] * m.m[1][2] * m.m[2][3] - m.m[0][2] * m.m[1][3] * m.m[2][1] - m.m[0][3] * m.m[1][1] * m.m[2][2] + m.m[0][3] * m.m[1][2] * m.m[2][1] + m.m[0][2] * m.m[1][1] * m.m[2][3] + m.m[0][1] * m.m[1][3] * m.m[2][2]);
-    result.m[1][0] = 1.0f / A * (-m.m[1][0] * m.m[2][2] * m.m[3][3] - m.m[1][2] * m.m[2][3] * m.m[3][0] - m.m[1][3] * m.m[2][0] * m.m[3][2] + m.m[1][3] * m.m[2][2] * m.m[3][0] + m.m[1][2] * m.m[2][0] * m.m[3][3] - m.m[1][0] * m.m[2][3] * m.m[3][2]);
+    result.m[1][0] = 1.0f / A * (-m.m[1][0] * m.m[2][2] * m.m[3][3] - m.m[1][2] * m.m[2][3] * m.m[3][0] - m.m[1][3] * m.m[2][0] * m.m[3][2] + m.m[1][3] * m.m[2][2] * m.m[3][0] + m.m[1][2] * m.m[2][0] * m.m[3][3] + m.m[1][0] * m.m[2][3] * m.m[3][2]);
     result.m[1][1] = 1.0f / A * (m.m[0][0] * m.m[2][2] * m.m[3][3] + m.m[0][2] * m.m[2][3] * m.m[3][0] + m.m[0][3] * m.m[2][0] * m.m[3][2] - m.m[0][3] * m.m[2][2] * m.m[3][0] - m.m[0][2] * m.m[2][0] * m.m[3][3] - m.m[0][0] * m.m[2][3] * m.m[3][2]);
     result.m[1][2] = 1.0f / A * (-m.m[0][0] * m.m[1][2] * m.m[3][3] - m.m[0][2] * m.m[1][3] * m.m[3][0] - m.m[0][3] * m.m[1][0] * m.m[3][2] + m.m[0][3] * m.m[1][2] * m.m[3][0] + m.m[0][2] * m.m[1][0] * m.m[3][3] + m.m[0][0] * m.m[1][3] * m.m[3][2]);
     result.m[1][3] = 1.0f / A * (m.m[0][0] * m.m[1][2] * m.m[2][3] + m.m[0][2] * m.m[1][3] * m.m[2][0] + m.m[0][3] * m.m[1][0] * m.m[2][2] - m.m[0][3] * m.m[1][2] * m.m[2][0] - m.m[0][2] * m.m[1][0] * m.m[2][3] - m.m[0][0] * m.m[1][3] * m.m[2][2]);
@@ -198,12 +269,83 @@ Matrix4x4 Matrix::Inverse(const Matrix4x4& m) {
     result.m[2][3] = 1.0f / A * (-m.m[0][0] * m.m[1][1] * m.m[2][3] - m.m[0][1] * m.m[1][3] * m.m[2][0] - m.m[0][3] * m.m[1][0] * m.m[2][1] + m.m[0][3] * m.m[1][1] * m.m[2][0] + m.m[0][1] * m.m[1][0] * m.m[2][3] + m.m[0][0] * m.m[1][3] * m.m[2][1]);
     result.m[3][0] = 1.0f / A * (-m.m[1][0] * m.m[2][1] * m.m[3][2] - m.m[1][1] * m.m[2][2] * m.m[3][0] - m.m[1][2] * m.m[2][0] * m.m[3][1] + m.m[1][2] * m.m[2][1] * m.m[3][0] + m.m[1][1] * m.m[2][0] * m.m[3][2] + m.m[1][0] * m.m[2][2] * m.m[3][1]);
     result.m[3][1] = 1.0f / A * (m.m[0][0] * m.m[2][1] * m.m[3][2] + m.m[0][1] * m.m[2][2] * m.m[3][0] + m.m[0][2] * m.m[2][0] * m.m[3][1] - m.m[0][2] * m.m[2][1] * m.m[3][0] - m.m[0][1] * m.m[2][0] * m.m[3][2] - m.m[0][0] * m.m[2][2] * m.m[3][1]);
-    result.m[3][2] = 1.0f / A * (-m.m[0][0] * m.m[1][1] * m.m[3][2] - m.m[0][1] * m.m[1][0] * m.m[3][2] + m.m[0][0] * m.m[1][2] * m.m[3][1] + m.m[0][2] * m.m[1][1] * m.m[3][0] + m.m[0][1] * m.m[1][0] * m.m[3][0] - m.m[0][2] * m.m[1][0] * m.m[3][1]);
+    result.m[3][2] = 1.0f / A * (-m.m[0][0] * m.m[1][1] * m.m[3][2] - m.m[0][1] * m.m[1][2] * m.m[3][0] - m.m[0][2] * m.m[1][0] * m.m[3][1] + m.m[0][2] * m.m[1][1] * m.m[3][0] + m.m[0][1] * m.m[1][0] * m.m[3][2] + m.m[0][0] * m.m[1][2] * m.m[3][1]);
     result.m[3][3] = 1.0f / A * (m.m[0][0] * m.m[1][1] * m.m[2][2] + m.m[0][1] * m.m[1][2] * m.m[2][0] + m.m[0][2] * m.m[1][0] * m.m[2][1] - m.m[0][2] * m.m[1][1] * m.m[2][0] - m.m[0][1] * m.m[1][0] * m.m[2][2] - m.m[0][0] * m.m[1][2] * m.m[2][1]);
 
     return result;
 }
 
+// アフィン変換行列の逆行列
+Matrix4x4 Matrix::InverseAffine(const Matrix4x4& m) {
+    // 左上3x3の余因子
+    float c00 = m.m[1][1] * m.m[2][2] - m.m[1][2] * m.m[2][1];
+    float c01 = m.m[1][2] * m.m[2][0] - m.m[1][0] * m.m[2][2];
+    float c02 = m.m[1][0] * m.m[2][1] - m.m[1][1] * m.m[2][0];
+    // 3x3の行列式
+    float invDet = 1.0f / (m.m[0][0] * c00 + m.m[0][1] * c01 + m.m[0][2] * c02);
+
+    Matrix4x4 result = {};
+    result.m[0][0] = c00 * invDet;
+    result.m[0][1] = (m.m[0][2] * m.m[2][1] - m.m[0][1] * m.m[2][2]) * invDet;
+    result.m[0][2] = (m.m[0][1] * m.m[1][2] - m.m[0][2] * m.m[1][1]) * invDet;
+    result.m[1][0] = c01 * invDet;
+    result.m[1][1] = (m.m[0][0] * m.m[2][2] - m.m[0][2] * m.m[2][0]) * invDet;
+    result.m[1][2] = (m.m[0][2] * m.m[1][0] - m.m[0][0] * m.m[1][2]) * invDet;
+    result.m[2][0] = c02 * invDet;
+    result.m[2][1] = (m.m[0][1] * m.m[2][0] - m.m[0][0] * m.m[2][1]) * invDet;
+    result.m[2][2] = (m.m[0][0] * m.m[1][1] - m.m[0][1] * m.m[1][0]) * invDet;
+
+    // 平行移動は -t * A^-1
+    for (int j = 0; j < 3; j++) {
+        result.m[3][j] = -(m.m[3][0] * result.m[0][j] + m.m[3][1] * result.m[1][j] + m.m[3][2] * result.m[2][j]);
+    }
+    result.m[3][3] = 1.0f;
+
+    return result;
+}
+
+// 回転と平行移動のみの行列の逆行列
+Matrix4x4 Matrix::InverseRigid(const Matrix4x4& m) {
+    Matrix4x4 result = {};
+
+    // 回転部分は転置
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            result.m[i][j] = m.m[j][i];
+        }
+    }
+
+    // 平行移動は -t * R^T
+    for (int j = 0; j < 3; j++) {
+        result.m[3][j] = -(m.m[3][0] * m.m[j][0] + m.m[3][1] * m.m[j][1] + m.m[3][2] * m.m[j][2]);
+    }
+    result.m[3][3] = 1.0f;
+
+    return result;
+}
+
+// カメラのTransformからビュー行列を作る
+Matrix4x4 Matrix::MakeViewMatrix(const Transform& cameraTransform) {
+    // カメラ行列は S * R * T なので、逆行列は T^-1 * R^T * S^-1
+    float r[3][3];
+    MakeRotateXYZ(cameraTransform.rotate, r);
+    const float invScale[3] = { 1.0f / cameraTransform.scale.x, 1.0f / cameraTransform.scale.y, 1.0f / cameraTransform.scale.z };
+    const Vector3& t = cameraTransform.translate;
+
+    Matrix4x4 result = {};
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            result.m[i][j] = r[j][i] * invScale[j];
+        }
+    }
+    for (int j = 0; j < 3; j++) {
+        result.m[3][j] = -(t.x * result.m[0][j] + t.y * result.m[1][j] + t.z * result.m[2][j]);
+    }
+    result.m[3][3] = 1.0f;
+
+    return result;
+}
+
 Matrix4x4 Matrix::MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip) {
     Matrix4x4 result = { 2.0f / (right - left), 0.0f, 0.0f, 0.0f,
                          0.0f, 2.0f / (top - bottom), 0.0f, 0.0f,
@@ -1,48 +1,30 @@
 #pragma once
+#include "Vector.h"
+#include <cstddef>
 
 struct Matrix4x4 {
 	float m[4][4];
 };
 
-// 2次元ベクトル
-struct Vector2 {
-	float x;
-	float y;
+// 座標変換
+struct Transform {
+	Vector3 scale;
+	Vector3 rotate;
+	Vector3 translate;
 };
 
-// 3次元ベクトル
-struct Vector3 {
-	float x;
-	float y;
-	float z;
+// 座標変換用行列
+struct TransformationMatrix {
+	Matrix4x4 WVP;
+	Matrix4x4 World;
 };
 
-// 4次元ベクトル
-struct Vector4 {
-	float x;
-	float y;
-	float z;
-	float w;
-};
-
-const Vector3 operator+(const Vector3& v1, const Vector3& v2);
-
-const Vector3 operator*(const Vector3& v1, const float f);
-
-Vector3& operator+=(Vector3& lhv, const Vector3& rhv);
-Vector3& operator-=(Vector3& lhv, const Vector3& rhv);
-Vector3& operator*=(Vector3& v, float s);
-Vector3& operator/=(Vector3& v, float s);
-
 // 代入演算子オーバーロード
 Matrix4x4& operator*=(Matrix4x4& lhm, const Matrix4x4& rhm);
 
 // 2項演算子オーバーロード
 Matrix4x4 operator*(const Matrix4x4& m1, const Matrix4x4& m2);
 
-Vector3 operator+(const Vector3& v);
-Vector3 operator-(const Vector3& v);
-
 class Matrix {
 public:
 	// 単位行列の作成
@@ -51,6 +33,9 @@ public:
 	// 行列の積
 	Matrix4x4 Multiply(const Matrix4x4& m1, const Matrix4x4& m2);
 
+	// 行列の積をまとめて計算する。result[i] = m1[i] * m2
+	void MultiplyBatch(const Matrix4x4* m1, const Matrix4x4& m2, Matrix4x4* result, size_t count);
+
 	// 拡大縮小行列
 	Matrix4x4 MakeScaleMatrix(const Vector3& scale);
 
@@ -66,6 +51,8 @@ public:
 
 	// アフィン変換
 	Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
+	// アフィン変換（各行列を掛け合わせて作る参照実装）
+	Matrix4x4 MakeAffineMatrixReference(const Vector3& scale, const Vector3& rotate, const Vector3& translate);
 
 	// 透視投影行列
 	Matrix4x4 MakePerspectiveFovMatrix(float fovY, float aspectRatio, float nearClip, float farclip);
@@ -73,6 +60,15 @@ public:
 	// 逆行列
 	Matrix4x4 Inverse(const Matrix4x4& m);
 
+	// アフィン変換行列の逆行列（4列目が(0,0,0,1)の行列専用）
+	Matrix4x4 InverseAffine(const Matrix4x4& m);
+
+	// 回転と平行移動のみの行列の逆行列（回転部分を転置する）
+	Matrix4x4 InverseRigid(const Matrix4x4& m);
+
+	// カメラのTransformからビュー行列を作る
+	Matrix4x4 MakeViewMatrix(const Transform& cameraTransform);
+
 	// 正射影行列
 	Matrix4x4 MakeOrthographicMatrix(float left, float top, float right, float bottom, float nearClip, float farClip);
 };
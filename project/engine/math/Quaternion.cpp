@@ -0,0 +1,158 @@
+#include "Quaternion.h"
+#include <cmath>
+
+Quaternion operator*(const Quaternion& q1, const Quaternion& q2) {
+    return {
+        q1.w * q2.x + q1.x * q2.w + q1.y * q2.z - q1.z * q2.y,
+        q1.w * q2.y - q1.x * q2.z + q1.y * q2.w + q1.z * q2.x,
+        q1.w * q2.z + q1.x * q2.y - q1.y * q2.x + q1.z * q2.w,
+        q1.w * q2.w - q1.x * q2.x - q1.y * q2.y - q1.z * q2.z,
+    };
+}
+
+Quaternion& operator*=(Quaternion& lhq, const Quaternion& rhq) {
+    lhq = lhq * rhq;
+    return lhq;
+}
+
+// 単位クォータニオン
+Quaternion IdentityQuaternion() {
+    return { 0.0f, 0.0f, 0.0f, 1.0f };
+}
+
+// 共役クォータニオン
+Quaternion Conjugate(const Quaternion& q) {
+    return { -q.x, -q.y, -q.z, q.w };
+}
+
+// ノルム
+float Norm(const Quaternion& q) {
+    return std::sqrt(Dot(q, q));
+}
+
+// 正規化
+Quaternion Normalize(const Quaternion& q) {
+    float norm = Norm(q);
+    if (norm == 0.0f) {
+        return q;
+    }
+    float invNorm = 1.0f / norm;
+    return { q.x * invNorm, q.y * invNorm, q.z * invNorm, q.w * invNorm };
+}
+
+// 逆クォータニオン
+Quaternion Inverse(const Quaternion& q) {
+    float invNormSq = 1.0f / Dot(q, q);
+    return { -q.x * invNormSq, -q.y * invNormSq, -q.z * invNormSq, q.w * invNormSq };
+}
+
+// 内積
+float Dot(const Quaternion& q1, const Quaternion& q2) {
+    return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+
+// 任意軸回転のクォータニオン
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle) {
+    float s = std::sin(angle * 0.5f);
+    return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+}
+
+// オイラー角からクォータニオンを作る
+Quaternion MakeRotateEulerQuaternion(const Vector3& rotate) {
+    // qz * qy * qx を展開したもの
+    const float sx = std::sin(rotate.x * 0.5f), cx = std::cos(rotate.x * 0.5f);
+    const float sy = std::sin(rotate.y * 0.5f), cy = std::cos(rotate.y * 0.5f);
+    const float sz = std::sin(rotate.z * 0.5f), cz = std::cos(rotate.z * 0.5f);
+
+    return {
+        cz * cy * sx - sz * sy * cx,
+        cz * sy * cx + sz * cy * sx,
+        sz * cy * cx - cz * sy * sx,
+        cz * cy * cx + sz * sy * sx,
+    };
+}
+
+// ベクトルを回転させる
+Vector3 RotateVector(const Vector3& vector, const Quaternion& q) {
+    // v' = v + 2w(u×v) + 2u×(u×v)
+    const Vector3 u = { q.x, q.y, q.z };
+    const Vector3 t = Cross(u, vector) * 2.0f;
+    return vector + t * q.w + Cross(u, t);
+}
+
+// 回転行列
+Matrix4x4 MakeRotateMatrix(const Quaternion& q) {
+    return MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, q, { 0.0f, 0.0f, 0.0f });
+}
+
+// 拡大縮小・回転・平行移動から直接アフィン変換行列を作る
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate) {
+    const float x2 = rotate.x + rotate.x, y2 = rotate.y + rotate.y, z2 = rotate.z + rotate.z;
+    const float xx = rotate.x * x2, yy = rotate.y * y2, zz = rotate.z * z2;
+    const float xy = rotate.x * y2, xz = rotate.x * z2, yz = rotate.y * z2;
+    const float wx = rotate.w * x2, wy = rotate.w * y2, wz = rotate.w * z2;
+
+    // 行ベクトルに右から掛ける形なので、一般的な回転行列の転置になる
+    Matrix4x4 result;
+    result.m[0][0] = scale.x * (1.0f - yy - zz); result.m[0][1] = scale.x * (xy + wz);        result.m[0][2] = scale.x * (xz - wy);        result.m[0][3] = 0.0f;
+    result.m[1][0] = scale.y * (xy - wz);        result.m[1][1] = scale.y * (1.0f - xx - zz); result.m[1][2] = scale.y * (yz + wx);        result.m[1][3] = 0.0f;
+    result.m[2][0] = scale.z * (xz + wy);        result.m[2][1] = scale.z * (yz - wx);        result.m[2][2] = scale.z * (1.0f - xx - yy); result.m[2][3] = 0.0f;
+    result.m[3][0] = translate.x;                result.m[3][1] = translate.y;                result.m[3][2] = translate.z;                result.m[3][3] = 1.0f;
+
+    return result;
+}
+
+// 球面線形補間
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t) {
+    float dot = Dot(q0, q1);
+    Quaternion end = q1;
+    // 遠回りしないように反転する
+    if (dot < 0.0f) {
+        end = { -q1.x, -q1.y, -q1.z, -q1.w };
+        dot = -dot;
+    }
+
+    // ほぼ同じ向きならNlerpで十分
+    if (dot >= 1.0f - 0.0005f) {
+        return Nlerp(q0, end, t);
+    }
+
+    float theta = std::acos(dot);
+    float invSin = 1.0f / std::sin(theta);
+    float scale0 = std::sin((1.0f - t) * theta) * invSin;
+    float scale1 = std::sin(t * theta) * invSin;
+
+    return {
+        scale0 * q0.x + scale1 * end.x,
+        scale0 * q0.y + scale1 * end.y,
+        scale0 * q0.z + scale1 * end.z,
+        scale0 * q0.w + scale1 * end.w,
+    };
+}
+
+// 正規化線形補間
+Quaternion Nlerp(const Quaternion& q0, const Quaternion& q1, float t) {
+    // 遠回りしないように符号を合わせる
+    float sign = Dot(q0, q1) < 0.0f ? -1.0f : 1.0f;
+    float t0 = 1.0f - t;
+    float t1 = t * sign;
+
+    Quaternion result = {
+        t0 * q0.x + t1 * q1.x,
+        t0 * q0.y + t1 * q1.y,
+        t0 * q0.z + t1 * q1.z,
+        t0 * q0.w + t1 * q1.w,
+    };
+    return Normalize(result);
+}
+
+// 角速度でdeltaTime分回転させる
+Quaternion IntegrateAngularVelocity(const Quaternion& q, const Vector3& angularVelocity, float deltaTime) {
+    // dq/dt = 0.5 * ω * q を1ステップ進めて正規化する
+    const Quaternion omega = { angularVelocity.x, angularVelocity.y, angularVelocity.z, 0.0f };
+    const Quaternion dq = omega * q;
+    const float h = 0.5f * deltaTime;
+
+    Quaternion result = { q.x + dq.x * h, q.y + dq.y * h, q.z + dq.z * h, q.w + dq.w * h };
+    return Normalize(result);
+}
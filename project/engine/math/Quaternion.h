@@ -0,0 +1,57 @@
+#pragma once
+#include "Matrix.h"
+
+// クォータニオン
+// 積 q1 * q2 は「q2で回してからq1で回す」回転を表す
+struct Quaternion {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+// 2項演算子オーバーロード
+Quaternion operator*(const Quaternion& q1, const Quaternion& q2);
+Quaternion& operator*=(Quaternion& lhq, const Quaternion& rhq);
+
+// 単位クォータニオン
+Quaternion IdentityQuaternion();
+
+// 共役クォータニオン
+Quaternion Conjugate(const Quaternion& q);
+
+// ノルム
+float Norm(const Quaternion& q);
+
+// 正規化
+Quaternion Normalize(const Quaternion& q);
+
+// 逆クォータニオン
+Quaternion Inverse(const Quaternion& q);
+
+// 内積
+float Dot(const Quaternion& q1, const Quaternion& q2);
+
+// 任意軸回転のクォータニオン（axisは正規化済みであること）
+Quaternion MakeRotateAxisAngleQuaternion(const Vector3& axis, float angle);
+
+// オイラー角（X→Y→Zの順に回転）からクォータニオンを作る。MakeAffineMatrixと同じ回転になる
+Quaternion MakeRotateEulerQuaternion(const Vector3& rotate);
+
+// ベクトルを回転させる
+Vector3 RotateVector(const Vector3& vector, const Quaternion& q);
+
+// 回転行列
+Matrix4x4 MakeRotateMatrix(const Quaternion& q);
+
+// 拡大縮小・回転・平行移動から直接アフィン変換行列を作る
+Matrix4x4 MakeAffineMatrix(const Vector3& scale, const Quaternion& rotate, const Vector3& translate);
+
+// 球面線形補間（最短経路）
+Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t);
+
+// 正規化線形補間（最短経路）。Slerpより軽いが角速度は一定にならない
+Quaternion Nlerp(const Quaternion& q0, const Quaternion& q1, float t);
+
+// 角速度（ワールド空間、rad/s）でdeltaTime分回転させる
+Quaternion IntegrateAngularVelocity(const Quaternion& q, const Vector3& angularVelocity, float deltaTime);
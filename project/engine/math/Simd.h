@@ -0,0 +1,11 @@
+#pragma once
+
+// SIMD命令の選択
+// x64ではSSE2が常に使える。/arch:AVX2でビルドした場合はAVX2(FMA)を使う
+#if defined(_M_X64) || defined(__SSE2__)
+#define MATH_USE_SSE
+#include <immintrin.h>
+#if defined(__AVX2__)
+#define MATH_USE_AVX2
+#endif
+#endif
@@ -0,0 +1,185 @@
+#include "TransformArray.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace {
+#ifdef MATH_USE_SSE
+    // 4要素のsinとcosをまとめて求める
+    // π/2の倍数を引いて[-π/4, π/4]にし、多項式で近似してから象限に合わせて入れ替える（誤差は数ULP）
+    void SinCos(__m128 x, __m128& sinResult, __m128& cosResult) {
+        const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+        const __m128 q = _mm_cvtepi32_ps(quadrant);
+        // π/2を3つに分けて引き、桁落ちを防ぐ
+        __m128 y = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+        y = _mm_sub_ps(y, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+        y = _mm_sub_ps(y, _mm_mul_ps(q, _mm_set1_ps(7.549789948768648e-8f)));
+        const __m128 y2 = _mm_mul_ps(y, y);
+
+        __m128 sinPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), y2), _mm_set1_ps(8.3321608736e-3f));
+        sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, y2), _mm_set1_ps(-1.6666654611e-1f));
+        sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, y2), y), y);
+        __m128 cosPoly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), y2), _mm_set1_ps(-1.388731625493765e-3f));
+        cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, y2), _mm_set1_ps(4.166664568298827e-2f));
+        cosPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(cosPoly, y2), y2), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y2, _mm_set1_ps(0.5f))));
+
+        // 奇数の象限ではsinとcosが入れ替わり、象限によって符号が変わる
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        const __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+        const __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+        sinResult = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cosPoly), _mm_andnot_ps(swap, sinPoly)), sinSign);
+        cosResult = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sinPoly), _mm_andnot_ps(swap, cosPoly)), cosSign);
+    }
+#endif
+}
+
+void TransformArray::Resize(size_t count) {
+    for (Stream* stream : { &scale, &rotate, &translate }) {
+        stream->x.resize(count);
+        stream->y.resize(count);
+        stream->z.resize(count);
+    }
+}
+
+void TransformArray::Set(size_t index, const Transform& transform) {
+    scale.x[index] = transform.scale.x; scale.y[index] = transform.scale.y; scale.z[index] = transform.scale.z;
+    rotate.x[index] = transform.rotate.x; rotate.y[index] = transform.rotate.y; rotate.z[index] = transform.rotate.z;
+    translate.x[index] = transform.translate.x; translate.y[index] = transform.translate.y; translate.z[index] = transform.translate.z;
+}
+
+Transform TransformArray::Get(size_t index) const {
+    Transform result;
+    result.scale = { scale.x[index], scale.y[index], scale.z[index] };
+    result.rotate = { rotate.x[index], rotate.y[index], rotate.z[index] };
+    result.translate = { translate.x[index], translate.y[index], translate.z[index] };
+    return result;
+}
+
+void TransformArray::BuildWorldMatrices(std::span<TransformationMatrix> output, const Matrix4x4& viewProjection) const {
+    assert(output.size() == GetSize());
+    WriteWorldMatrices(output.data(), viewProjection, nullptr);
+}
+
+size_t TransformArray::BuildWorldMatrices(std::span<TransformationMatrix> output, const Matrix4x4& viewProjection, std::span<const uint8_t> visible) const {
+    assert(output.size() >= GetSize() && visible.size() == GetSize());
+    return WriteWorldMatrices(output.data(), viewProjection, visible.data());
+}
+
+size_t TransformArray::WriteWorldMatrices(TransformationMatrix* output, const Matrix4x4& viewProjection, const uint8_t* visible) const {
+    const size_t count = GetSize();
+    size_t written = 0;
+    size_t begin = 0;
+
+#ifdef MATH_USE_SSE
+    // ViewProjectionの各成分を4要素に広げておく
+    __m128 vp[4][4];
+    for (int row = 0; row < 4; row++) {
+        for (int column = 0; column < 4; column++) {
+            vp[row][column] = _mm_set1_ps(viewProjection.m[row][column]);
+        }
+    }
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    // 4要素ずつ、成分ごとの配列から直接読んで4要素分の成分を並べて計算し、最後に転置して書き込む
+    for (; begin + 4 <= count; begin += 4) {
+        // 4つとも見えなければsin/cosも求めない
+        if (visible != nullptr) {
+            uint32_t visibleBytes;
+            std::memcpy(&visibleBytes, visible + begin, sizeof(visibleBytes));
+            if (visibleBytes == 0) {
+                continue;
+            }
+        }
+
+        __m128 sx, cx, sy, cy, sz, cz;
+        SinCos(_mm_loadu_ps(&rotate.x[begin]), sx, cx);
+        SinCos(_mm_loadu_ps(&rotate.y[begin]), sy, cy);
+        SinCos(_mm_loadu_ps(&rotate.z[begin]), sz, cz);
+        const __m128 scaleX = _mm_loadu_ps(&scale.x[begin]);
+        const __m128 scaleY = _mm_loadu_ps(&scale.y[begin]);
+        const __m128 scaleZ = _mm_loadu_ps(&scale.z[begin]);
+
+        // S * Rx * Ry * Rz の各成分（Worldの4列目は(0,0,0,1)）
+        const __m128 sxsy = _mm_mul_ps(sx, sy);
+        const __m128 cxsy = _mm_mul_ps(cx, sy);
+        __m128 world[4][4];
+        world[0][0] = _mm_mul_ps(scaleX, _mm_mul_ps(cy, cz));
+        world[0][1] = _mm_mul_ps(scaleX, _mm_mul_ps(cy, sz));
+        world[0][2] = _mm_mul_ps(scaleX, _mm_xor_ps(sy, _mm_set1_ps(-0.0f)));
+        world[1][0] = _mm_mul_ps(scaleY, _mm_sub_ps(_mm_mul_ps(sxsy, cz), _mm_mul_ps(cx, sz)));
+        world[1][1] = _mm_mul_ps(scaleY, _mm_add_ps(_mm_mul_ps(sxsy, sz), _mm_mul_ps(cx, cz)));
+        world[1][2] = _mm_mul_ps(scaleY, _mm_mul_ps(sx, cy));
+        world[2][0] = _mm_mul_ps(scaleZ, _mm_add_ps(_mm_mul_ps(cxsy, cz), _mm_mul_ps(sx, sz)));
+        world[2][1] = _mm_mul_ps(scaleZ, _mm_sub_ps(_mm_mul_ps(cxsy, sz), _mm_mul_ps(sx, cz)));
+        world[2][2] = _mm_mul_ps(scaleZ, _mm_mul_ps(cx, cy));
+        world[3][0] = _mm_loadu_ps(&translate.x[begin]);
+        world[3][1] = _mm_loadu_ps(&translate.y[begin]);
+        world[3][2] = _mm_loadu_ps(&translate.z[begin]);
+        world[0][3] = zero;
+        world[1][3] = zero;
+        world[2][3] = zero;
+        world[3][3] = one;
+
+        // WVPの各行は3回(最後の行は4回)の積和で済む
+        __m128 wvp[4][4];
+        for (int row = 0; row < 4; row++) {
+            for (int column = 0; column < 4; column++) {
+                wvp[row][column] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(world[row][0], vp[0][column]), _mm_mul_ps(world[row][1], vp[1][column])), _mm_mul_ps(world[row][2], vp[2][column]));
+            }
+        }
+        for (int column = 0; column < 4; column++) {
+            wvp[3][column] = _mm_add_ps(wvp[3][column], vp[3][column]);
+        }
+
+        // 行ごとに転置すると、i番目のレジスタがi番目の要素のその行になる
+        for (int row = 0; row < 4; row++) {
+            _MM_TRANSPOSE4_PS(world[row][0], world[row][1], world[row][2], world[row][3]);
+            _MM_TRANSPOSE4_PS(wvp[row][0], wvp[row][1], wvp[row][2], wvp[row][3]);
+        }
+
+        // アップロードバッファには書き込みだけを順番に行う
+        for (int i = 0; i < 4; i++) {
+            if (visible != nullptr && visible[begin + i] == 0) {
+                continue;
+            }
+            TransformationMatrix& out = output[written++];
+            for (int row = 0; row < 4; row++) {
+                _mm_storeu_ps(out.WVP.m[row], wvp[row][i]);
+            }
+            for (int row = 0; row < 4; row++) {
+                _mm_storeu_ps(out.World.m[row], world[row][i]);
+            }
+        }
+    }
+#endif
+
+    // 4つに満たない残り（SSEが使えなければ全部）は1要素ずつ
+    for (size_t index = begin; index < count; index++) {
+        if (visible != nullptr && visible[index] == 0) {
+            continue;
+        }
+        const float sx = std::sin(rotate.x[index]), cx = std::cos(rotate.x[index]);
+        const float sy = std::sin(rotate.y[index]), cy = std::cos(rotate.y[index]);
+        const float sz = std::sin(rotate.z[index]), cz = std::cos(rotate.z[index]);
+        const float scaleX = scale.x[index], scaleY = scale.y[index], scaleZ = scale.z[index];
+
+        // S * Rx * Ry * Rz の各行
+        Matrix4x4 world = {
+            scaleX * (cy * cz), scaleX * (cy * sz), scaleX * -sy, 0.0f,
+            scaleY * (sx * sy * cz - cx * sz), scaleY * (sx * sy * sz + cx * cz), scaleY * (sx * cy), 0.0f,
+            scaleZ * (cx * sy * cz + sx * sz), scaleZ * (cx * sy * sz - sx * cz), scaleZ * (cx * cy), 0.0f,
+            translate.x[index], translate.y[index], translate.z[index], 1.0f };
+        Matrix4x4 wvp;
+        for (int row = 0; row < 4; row++) {
+            for (int column = 0; column < 4; column++) {
+                wvp.m[row][column] = world.m[row][0] * viewProjection.m[0][column] + world.m[row][1] * viewProjection.m[1][column] + world.m[row][2] * viewProjection.m[2][column] + world.m[row][3] * viewProjection.m[3][column];
+            }
+        }
+        output[written++] = { wvp, world };
+    }
+
+    return written;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "Matrix.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 座標変換の配列
+// scale/rotate/translateをx,y,z成分ごとに連続した配列で持つ（SoA）
+class TransformArray {
+public:
+	// x,y,z成分ごとの配列
+	struct Stream {
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+	};
+
+	// 要素数の変更
+	void Resize(size_t count);
+
+	// 要素数
+	size_t GetSize() const { return translate.x.size(); }
+
+	// 1要素分の設定・取得
+	void Set(size_t index, const Transform& transform);
+	Transform Get(size_t index) const;
+
+	// 全要素のWorldとWVPを作り、outputに書き込む
+	// outputはMapしたアップロードバッファを直接渡してよい（書き込みのみ行う）
+	void BuildWorldMatrices(std::span<TransformationMatrix> output, const Matrix4x4& viewProjection) const;
+
+	// visible[i]が0でない要素だけを前から詰めて書き込み、書き込んだ数を返す
+	size_t BuildWorldMatrices(std::span<TransformationMatrix> output, const Matrix4x4& viewProjection, std::span<const uint8_t> visible) const;
+
+	Stream scale;
+	Stream rotate;
+	Stream translate;
+
+private:
+	// visibleがnullptrなら全要素を書き込む
+	size_t WriteWorldMatrices(TransformationMatrix* output, const Matrix4x4& viewProjection, const uint8_t* visible) const;
+};
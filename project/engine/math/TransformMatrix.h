@@ -0,0 +1,106 @@
+#pragma once
+#include "Matrix.h"
+#include <cmath>
+#include <cstdint>
+
+// 座標変換が持つ成分のフラグ。何も立っていなければ平行移動のみ
+enum TransformFlag : uint32_t {
+	kTransformFlagNone = 0,
+	//!< 全軸同じ拡大縮小
+	kTransformFlagUniformScale = 1 << 0,
+	//!< 軸ごとに異なる拡大縮小
+	kTransformFlagScale = 1 << 1,
+	//!< Y軸回転のみ
+	kTransformFlagYaw = 1 << 2,
+	//!< 任意の回転
+	kTransformFlagRotate = 1 << 3,
+};
+
+// Transformの値からフラグを求める
+inline uint32_t ClassifyTransform(const Transform& transform) {
+	uint32_t flags = kTransformFlagNone;
+
+	const Vector3& s = transform.scale;
+	if (s.x != s.y || s.y != s.z) {
+		flags |= kTransformFlagScale;
+	} else if (s.x != 1.0f) {
+		flags |= kTransformFlagUniformScale;
+	}
+
+	const Vector3& r = transform.rotate;
+	if (r.x != 0.0f || r.z != 0.0f) {
+		flags |= kTransformFlagRotate;
+	} else if (r.y != 0.0f) {
+		flags |= kTransformFlagYaw;
+	}
+
+	return flags;
+}
+
+// フラグごとに特殊化したアフィン変換行列の作成
+// フラグにない成分は読まないので、呼び出し側がフラグを保証すること
+template <uint32_t kFlags>
+inline Matrix4x4 MakeTransformMatrix(const Transform& transform) {
+	// 任意の回転、または非一様スケールと回転の組み合わせは汎用版
+	if constexpr ((kFlags & kTransformFlagRotate) != 0) {
+		Matrix matrix;
+		return matrix.MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
+	} else {
+		// 拡大縮小
+		float sx = 1.0f, sy = 1.0f, sz = 1.0f;
+		if constexpr ((kFlags & kTransformFlagScale) != 0) {
+			sx = transform.scale.x; sy = transform.scale.y; sz = transform.scale.z;
+		} else if constexpr ((kFlags & kTransformFlagUniformScale) != 0) {
+			sx = sy = sz = transform.scale.x;
+		}
+
+		const Vector3& t = transform.translate;
+		if constexpr ((kFlags & kTransformFlagYaw) != 0) {
+			// Y軸回転のみ。sin/cosは1回ずつ
+			const float s = std::sin(transform.rotate.y);
+			const float c = std::cos(transform.rotate.y);
+			return { sx * c, 0.0f, -sx * s, 0.0f,
+					 0.0f, sy, 0.0f, 0.0f,
+					 sz * s, 0.0f, sz * c, 0.0f,
+					 t.x, t.y, t.z, 1.0f };
+		} else {
+			// 回転なし
+			return { sx, 0.0f, 0.0f, 0.0f,
+					 0.0f, sy, 0.0f, 0.0f,
+					 0.0f, 0.0f, sz, 0.0f,
+					 t.x, t.y, t.z, 1.0f };
+		}
+	}
+}
+
+// フラグから一番軽い作り方を選んでアフィン変換行列を作る
+inline Matrix4x4 MakeTransformMatrix(const Transform& transform, uint32_t flags) {
+	if ((flags & kTransformFlagRotate) != 0) {
+		return MakeTransformMatrix<kTransformFlagRotate>(transform);
+	}
+
+	// 非一様スケールが立っていれば一様スケールは見なくてよい
+	if ((flags & kTransformFlagScale) != 0) {
+		flags &= ~kTransformFlagUniformScale;
+	}
+
+	switch (flags & (kTransformFlagUniformScale | kTransformFlagScale | kTransformFlagYaw)) {
+	case kTransformFlagNone:
+		return MakeTransformMatrix<kTransformFlagNone>(transform);
+	case kTransformFlagUniformScale:
+		return MakeTransformMatrix<kTransformFlagUniformScale>(transform);
+	case kTransformFlagYaw:
+		return MakeTransformMatrix<kTransformFlagYaw>(transform);
+	case kTransformFlagUniformScale | kTransformFlagYaw:
+		return MakeTransformMatrix<kTransformFlagUniformScale | kTransformFlagYaw>(transform);
+	case kTransformFlagYaw | kTransformFlagScale:
+		return MakeTransformMatrix<kTransformFlagYaw | kTransformFlagScale>(transform);
+	default:
+		return MakeTransformMatrix<kTransformFlagScale>(transform);
+	}
+}
+
+// Transformの値からフラグを判定して作る
+inline Matrix4x4 MakeTransformMatrix(const Transform& transform) {
+	return MakeTransformMatrix(transform, ClassifyTransform(transform));
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <cmath>
+
+// 2次元ベクトル
+struct Vector2 {
+	float x;
+	float y;
+};
+
+// 3次元ベクトル
+struct Vector3 {
+	float x;
+	float y;
+	float z;
+};
+
+// 4次元ベクトル
+struct Vector4 {
+	float x;
+	float y;
+	float z;
+	float w;
+};
+
+// 単項演算子オーバーロード
+constexpr Vector2 operator+(const Vector2& v) { return v; }
+constexpr Vector2 operator-(const Vector2& v) { return { -v.x, -v.y }; }
+constexpr Vector3 operator+(const Vector3& v) { return v; }
+constexpr Vector3 operator-(const Vector3& v) { return { -v.x, -v.y, -v.z }; }
+constexpr Vector4 operator+(const Vector4& v) { return v; }
+constexpr Vector4 operator-(const Vector4& v) { return { -v.x, -v.y, -v.z, -v.w }; }
+
+// 代入演算子オーバーロード
+constexpr Vector2& operator+=(Vector2& lhv, const Vector2& rhv) { lhv.x += rhv.x; lhv.y += rhv.y; return lhv; }
+constexpr Vector2& operator-=(Vector2& lhv, const Vector2& rhv) { lhv.x -= rhv.x; lhv.y -= rhv.y; return lhv; }
+constexpr Vector2& operator*=(Vector2& v, float s) { v.x *= s; v.y *= s; return v; }
+constexpr Vector2& operator/=(Vector2& v, float s) { v.x /= s; v.y /= s; return v; }
+
+constexpr Vector3& operator+=(Vector3& lhv, const Vector3& rhv) { lhv.x += rhv.x; lhv.y += rhv.y; lhv.z += rhv.z; return lhv; }
+constexpr Vector3& operator-=(Vector3& lhv, const Vector3& rhv) { lhv.x -= rhv.x; lhv.y -= rhv.y; lhv.z -= rhv.z; return lhv; }
+constexpr Vector3& operator*=(Vector3& v, float s) { v.x *= s; v.y *= s; v.z *= s; return v; }
+constexpr Vector3& operator/=(Vector3& v, float s) { v.x /= s; v.y /= s; v.z /= s; return v; }
+
+constexpr Vector4& operator+=(Vector4& lhv, const Vector4& rhv) { lhv.x += rhv.x; lhv.y += rhv.y; lhv.z += rhv.z; lhv.w += rhv.w; return lhv; }
+constexpr Vector4& operator-=(Vector4& lhv, const Vector4& rhv) { lhv.x -= rhv.x; lhv.y -= rhv.y; lhv.z -= rhv.z; lhv.w -= rhv.w; return lhv; }
+constexpr Vector4& operator*=(Vector4& v, float s) { v.x *= s; v.y *= s; v.z *= s; v.w *= s; return v; }
+constexpr Vector4& operator/=(Vector4& v, float s) { v.x /= s; v.y /= s; v.z /= s; v.w /= s; return v; }
+
+// 2項演算子オーバーロード
+constexpr Vector2 operator+(const Vector2& v1, const Vector2& v2) { return { v1.x + v2.x, v1.y + v2.y }; }
+constexpr Vector2 operator-(const Vector2& v1, const Vector2& v2) { return { v1.x - v2.x, v1.y - v2.y }; }
+constexpr Vector2 operator*(const Vector2& v1, const Vector2& v2) { return { v1.x * v2.x, v1.y * v2.y }; }
+constexpr Vector2 operator*(const Vector2& v, float s) { return { v.x * s, v.y * s }; }
+constexpr Vector2 operator*(float s, const Vector2& v) { return v * s; }
+constexpr Vector2 operator/(const Vector2& v, float s) { return { v.x / s, v.y / s }; }
+
+constexpr Vector3 operator+(const Vector3& v1, const Vector3& v2) { return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z }; }
+constexpr Vector3 operator-(const Vector3& v1, const Vector3& v2) { return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z }; }
+constexpr Vector3 operator*(const Vector3& v1, const Vector3& v2) { return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z }; }
+constexpr Vector3 operator*(const Vector3& v, float s) { return { v.x * s, v.y * s, v.z * s }; }
+constexpr Vector3 operator*(float s, const Vector3& v) { return v * s; }
+constexpr Vector3 operator/(const Vector3& v, float s) { return { v.x / s, v.y / s, v.z / s }; }
+
+constexpr Vector4 operator+(const Vector4& v1, const Vector4& v2) { return { v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w }; }
+constexpr Vector4 operator-(const Vector4& v1, const Vector4& v2) { return { v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w }; }
+constexpr Vector4 operator*(const Vector4& v1, const Vector4& v2) { return { v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w }; }
+constexpr Vector4 operator*(const Vector4& v, float s) { return { v.x * s, v.y * s, v.z * s, v.w * s }; }
+constexpr Vector4 operator*(float s, const Vector4& v) { return v * s; }
+constexpr Vector4 operator/(const Vector4& v, float s) { return { v.x / s, v.y / s, v.z / s, v.w / s }; }
+
+// 比較演算子オーバーロード
+constexpr bool operator==(const Vector2& v1, const Vector2& v2) { return v1.x == v2.x && v1.y == v2.y; }
+constexpr bool operator==(const Vector3& v1, const Vector3& v2) { return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z; }
+constexpr bool operator==(const Vector4& v1, const Vector4& v2) { return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z && v1.w == v2.w; }
+
+// 内積
+constexpr float Dot(const Vector2& v1, const Vector2& v2) { return v1.x * v2.x + v1.y * v2.y; }
+constexpr float Dot(const Vector3& v1, const Vector3& v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z; }
+constexpr float Dot(const Vector4& v1, const Vector4& v2) { return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w; }
+
+// 外積
+constexpr float Cross(const Vector2& v1, const Vector2& v2) { return v1.x * v2.y - v1.y * v2.x; }
+constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) {
+	return { v1.y * v2.z - v1.z * v2.y, v1.z * v2.x - v1.x * v2.z, v1.x * v2.y - v1.y * v2.x };
+}
+
+// 長さの2乗
+constexpr float LengthSquared(const Vector2& v) { return Dot(v, v); }
+constexpr float LengthSquared(const Vector3& v) { return Dot(v, v); }
+constexpr float LengthSquared(const Vector4& v) { return Dot(v, v); }
+
+// 長さ
+inline float Length(const Vector2& v) { return std::sqrt(LengthSquared(v)); }
+inline float Length(const Vector3& v) { return std::sqrt(LengthSquared(v)); }
+inline float Length(const Vector4& v) { return std::sqrt(LengthSquared(v)); }
+
+// 正規化。長さ0のベクトルはそのまま返す
+inline Vector2 Normalize(const Vector2& v) {
+	float length = Length(v);
+	return length != 0.0f ? v / length : v;
+}
+inline Vector3 Normalize(const Vector3& v) {
+	float length = Length(v);
+	return length != 0.0f ? v / length : v;
+}
+inline Vector4 Normalize(const Vector4& v) {
+	float length = Length(v);
+	return length != 0.0f ? v / length : v;
+}
+
+// 線形補間
+constexpr Vector2 Lerp(const Vector2& v1, const Vector2& v2, float t) { return v1 + (v2 - v1) * t; }
+constexpr Vector3 Lerp(const Vector3& v1, const Vector3& v2, float t) { return v1 + (v2 - v1) * t; }
+constexpr Vector4 Lerp(const Vector4& v1, const Vector4& v2, float t) { return v1 + (v2 - v1) * t; }
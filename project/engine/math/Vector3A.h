@@ -0,0 +1,81 @@
+#pragma once
+#include "Vector.h"
+#include "Simd.h"
+
+// 16バイト境界に揃えた3次元ベクトル（SIMD計算用）
+// 中身はVector4と同じ並びで、wは常に0として扱う
+struct alignas(16) Vector3A {
+	float x;
+	float y;
+	float z;
+	float w;
+
+	Vector3A() = default;
+	constexpr Vector3A(float x, float y, float z) : x(x), y(y), z(z), w(0.0f) {}
+	explicit constexpr Vector3A(const Vector3& v) : x(v.x), y(v.y), z(v.z), w(0.0f) {}
+
+	// Vector3へ戻す
+	constexpr Vector3 ToVector3() const { return { x, y, z }; }
+};
+
+#ifdef MATH_USE_SSE
+// SIMDレジスタとの変換
+// 直前に要素ごとに書き込んだ値を16バイトで読むとストアフォワーディングが効かず大きく遅れるので、要素ごとに読んで組み立てる
+// メモリ上の値ならコンパイラがまとめて読んでくれる
+inline __m128 LoadVector3A(const Vector3A& v) { return _mm_setr_ps(v.x, v.y, v.z, v.w); }
+inline Vector3A StoreVector3A(__m128 v) {
+	Vector3A result;
+	_mm_store_ps(&result.x, v);
+	return result;
+}
+
+inline Vector3A operator+(const Vector3A& v1, const Vector3A& v2) { return StoreVector3A(_mm_add_ps(LoadVector3A(v1), LoadVector3A(v2))); }
+inline Vector3A operator-(const Vector3A& v1, const Vector3A& v2) { return StoreVector3A(_mm_sub_ps(LoadVector3A(v1), LoadVector3A(v2))); }
+inline Vector3A operator*(const Vector3A& v1, const Vector3A& v2) { return StoreVector3A(_mm_mul_ps(LoadVector3A(v1), LoadVector3A(v2))); }
+inline Vector3A operator*(const Vector3A& v, float s) { return StoreVector3A(_mm_mul_ps(LoadVector3A(v), _mm_set1_ps(s))); }
+inline Vector3A operator/(const Vector3A& v, float s) { return StoreVector3A(_mm_mul_ps(LoadVector3A(v), _mm_set1_ps(1.0f / s))); }
+
+// 内積（wは0なので4要素の和でよい）
+inline float Dot(const Vector3A& v1, const Vector3A& v2) {
+	__m128 m = _mm_mul_ps(LoadVector3A(v1), LoadVector3A(v2));
+	__m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+	s = _mm_add_ss(s, _mm_movehl_ps(s, s));
+	return _mm_cvtss_f32(s);
+}
+
+// 外積
+inline Vector3A Cross(const Vector3A& v1, const Vector3A& v2) {
+	__m128 a = LoadVector3A(v1);
+	__m128 b = LoadVector3A(v2);
+	__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+	return StoreVector3A(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+#else
+inline Vector3A operator+(const Vector3A& v1, const Vector3A& v2) { return Vector3A(v1.ToVector3() + v2.ToVector3()); }
+inline Vector3A operator-(const Vector3A& v1, const Vector3A& v2) { return Vector3A(v1.ToVector3() - v2.ToVector3()); }
+inline Vector3A operator*(const Vector3A& v1, const Vector3A& v2) { return Vector3A(v1.ToVector3() * v2.ToVector3()); }
+inline Vector3A operator*(const Vector3A& v, float s) { return Vector3A(v.ToVector3() * s); }
+inline Vector3A operator/(const Vector3A& v, float s) { return Vector3A(v.ToVector3() / s); }
+inline float Dot(const Vector3A& v1, const Vector3A& v2) { return Dot(v1.ToVector3(), v2.ToVector3()); }
+inline Vector3A Cross(const Vector3A& v1, const Vector3A& v2) { return Vector3A(Cross(v1.ToVector3(), v2.ToVector3())); }
+#endif
+
+inline Vector3A operator*(float s, const Vector3A& v) { return v * s; }
+inline Vector3A& operator+=(Vector3A& lhv, const Vector3A& rhv) { return lhv = lhv + rhv; }
+inline Vector3A& operator-=(Vector3A& lhv, const Vector3A& rhv) { return lhv = lhv - rhv; }
+inline Vector3A& operator*=(Vector3A& v, float s) { return v = v * s; }
+inline Vector3A& operator/=(Vector3A& v, float s) { return v = v / s; }
+
+// 長さ
+inline float Length(const Vector3A& v) { return std::sqrt(Dot(v, v)); }
+
+// 正規化。長さ0のベクトルはそのまま返す
+inline Vector3A Normalize(const Vector3A& v) {
+	float length = Length(v);
+	return length != 0.0f ? v / length : v;
+}
+
+// 線形補間
+inline Vector3A Lerp(const Vector3A& v1, const Vector3A& v2, float t) { return v1 + (v2 - v1) * t; }
@@ -1,9 +1,9 @@
 #include <Windows.h>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <fstream>
-#include <sstream>
 #include <chrono>
 #include <d3d12.h>
 #include <dxgi1_6.h>
@@ -13,6 +13,9 @@
 #include <dxgidebug.h>
 #include <dxcapi.h>
 #include "engine/math/Matrix.h"
+#include "engine/math/Geometry.h"
+#include "engine/math/TransformArray.h"
+#include "engine/math/TransformMatrix.h"
 #include "externals/imgui/imgui.h"
 #include "externals/imgui/imgui_impl_dx12.h"
 #include "externals/imgui/imgui_impl_win32.h"
@@ -22,8 +25,18 @@
 #include <wrl.h>
 #include <xaudio2.h>
 #include <random>
+#include <algorithm>
 #include "Input.h"
 #include "WinApp.h"
+#include "engine/base/AssetLoader.h"
+#include "engine/base/AssetRegistry.h"
+#include "engine/3d/Camera.h"
+#include "engine/3d/MeshBounds.h"
+#include "engine/3d/Meshlet.h"
+#include "engine/3d/MeshSimplifier.h"
+#include "engine/3d/ModelData.h"
+#include "engine/3d/PackedVertex.h"
+#include "engine/io/ObjLoader.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -36,20 +49,6 @@ using namespace DirectX;
 using namespace Microsoft::WRL;
 using namespace chrono;
 
-// 座標変換
-struct Transform {
-	Vector3 scale;
-	Vector3 rotate;
-	Vector3 translate;
-};
-
-// 頂点データ
-struct VertexData {
-	Vector4 position;
-	Vector2 texcoord;
-	Vector3 normal;
-};
-
 // マテリアル
 struct Material {
 	Vector4 color;
@@ -58,12 +57,6 @@ struct Material {
 	Matrix4x4 uvTransform;
 };
 
-// 座標変換用行列
-struct TransformationMatrix {
-	Matrix4x4 WVP;
-	Matrix4x4 World;
-};
-
 // 平行光源
 struct DirectionalLight {
 	Vector4 color;
@@ -71,17 +64,6 @@ struct DirectionalLight {
 	float intensity;
 };
 
-// マテリアルデータ
-struct MaterialData {
-	string textureFilePath;
-};
-
-// モデルデータ
-struct ModelData {
-	vector<VertexData> verticles;
-	MaterialData material;
-};
-
 // リークチェッカー
 struct D3DResourceLeakChecker {
 	~D3DResourceLeakChecker()
@@ -124,6 +106,18 @@ struct SoundData {
 	unsigned int bufferSize;
 };
 
+// GPUへ転送したテクスチャ
+struct TextureData {
+	ComPtr<ID3D12Resource> resource;
+	TexMetadata metadata;
+	// ミップマップを含めた画素のバイト数
+	size_t memorySize;
+};
+
+// 読み込んだアセットのメモリの予算。超えたら参照されていないものから捨てる
+const size_t kTextureMemoryBudget = 256 * 1024 * 1024;
+const size_t kSoundMemoryBudget = 64 * 1024 * 1024;
+
 // ブレンドモード
 enum BlendMode {
 	//!< ブレンドなし
@@ -310,11 +304,10 @@ CreateDescriptorHeap(
 	return descriptorHeap;
 }
 
-ScratchImage LoadTexture(const string& filePath) {
-	// テクスチャファイルを読んでプログラムで扱えるようにする
+ScratchImage LoadTexture(string_view contents) {
+	// メモリ上のテクスチャファイルの中身を読んでプログラムで扱えるようにする
 	ScratchImage image{};
-	wstring filePathW = ConvertString(filePath);
-	HRESULT hr = LoadFromWICFile(filePathW.c_str(), WIC_FLAGS_FORCE_SRGB, nullptr, image);
+	HRESULT hr = LoadFromWICMemory(contents.data(), contents.size(), WIC_FLAGS_FORCE_SRGB, nullptr, image);
 	assert(SUCCEEDED(hr));
 
 	// ミップマップの作成
@@ -357,6 +350,15 @@ CreateTextureResource(const ComPtr<ID3D12Device>& device, const TexMetadata& met
 	return resource;
 }
 
+// 読み込みが終わるまで代わりに使う1x1の白いテクスチャ
+ScratchImage MakePlaceholderTexture() {
+	ScratchImage image{};
+	HRESULT hr = image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 1, 1, 1, 1);
+	assert(SUCCEEDED(hr));
+	memset(image.GetPixels(), 0xFF, image.GetPixelsSize());
+	return image;
+}
+
 [[nodiscard]]
 ComPtr<ID3D12Resource>
 UploadTextureData(const ComPtr<ID3D12Resource>& texture, const ScratchImage& mipImages, const ComPtr<ID3D12Device>& device,
@@ -378,6 +380,17 @@ UploadTextureData(const ComPtr<ID3D12Resource>& texture, const ScratchImage& mip
 	return intermediateResource;
 }
 
+// metadataを基にテクスチャのSRVを作る
+void CreateTextureSrv(const ComPtr<ID3D12Device>& device, const ComPtr<ID3D12Resource>& texture, const TexMetadata& metadata,
+	D3D12_CPU_DESCRIPTOR_HANDLE handleCPU) {
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Format = metadata.format;
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
+	srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
+	device->CreateShaderResourceView(texture.Get(), &srvDesc, handleCPU);
+}
+
 ComPtr<ID3D12Resource>
 CreateDepthStencilTextureResource(const ComPtr<ID3D12Device>& device, int32_t width, int32_t height) {
 	// 生成するResourceの設定
@@ -424,118 +437,19 @@ D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptorHandle(const ComPtr<ID3D12Descriptor
 	return handleGPU;
 }
 
-MaterialData LoadMaterialTemplateFile(const string& directoryPath, const string& filename) {
-	// 中で必要となる変数の宣言
-	MaterialData materialData; // 構築するMaterialData
-	string line; // ファイルから読んだ1行を格納するもの
-	ifstream file(directoryPath + "/" + filename); // ファイルを開く
-	assert(file.is_open()); // とりあえず開けなかったら止める
-
-	// 実際にファイルを読み、MaterialDataを構築していく
-	while (getline(file, line)) {
-		string identifier;
-		istringstream s(line);
-		s >> identifier;
-
-		// identifierに応じた処理
-		if (identifier == "map_Kd") {
-			string textureFilename;
-			s >> textureFilename;
-			// 連結してファイルパスにする
-			materialData.textureFilePath = directoryPath + "/" + textureFilename;
-		}
-	}
-
-	// MaterialDataを返す
-	return materialData;
-}
-
-ModelData LoadObjFile(const string& directoryPath, const string& filename) {
-	// 中で必要となる変数の宣言
-	ModelData modelData; // 構築するModelData
-	vector<Vector4> positions; // 位置
-	vector<Vector3> normals; // 法線
-	vector<Vector2> texcoords; // テクスチャ座標
-	string line; // ファイルから読んだ1行を格納するもの
-
-	// ファイルを開く
-	ifstream file(directoryPath + "/" + filename); // ファイルを開く
-	assert(file.is_open()); // とりあえず開けなかったら止める
-
-	// ファイルを読み、ModelDataを構築
-	while (getline(file, line)) {
-		string identifier;
-		istringstream s(line);
-		s >> identifier; // 先頭の識別子を読む
-
-		// identifierに応じた
-		if (identifier == "v") {
-			Vector4 position;
-			s >> position.x >> position.y >> position.z;
-			position.x *= -1.0f;
-			position.w = 1.0f;
-			positions.push_back(position);
-		}
-		else if (identifier == "vt") {
-			Vector2 texcoord;
-			s >> texcoord.x >> texcoord.y;
-			texcoord.y = 1.0f - texcoord.y;
-			texcoords.push_back(texcoord);
-		}
-		else if (identifier == "vn") {
-			Vector3 normal;
-			s >> normal.x >> normal.y >> normal.z;
-			normal.x *= -1.0f;
-			normals.push_back(normal);
-		}
-		else if (identifier == "f") {
-			VertexData triangle[3];
-			// 面は三角形限定。その他は未対応
-			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex) {
-				string vertexDefinition;
-				s >> vertexDefinition;
-				// 頂点の要素へのIndexは「位置/UV/法線」で格納されているので、分解してIndexを取得する
-				istringstream v(vertexDefinition);
-				uint32_t elementIndices[3];
-				for (uint32_t element = 0; element < 3; ++element) {
-					string index;
-					getline(v, index, '/'); // 区切りでインデックスを読んでいく
-					elementIndices[element] = stoi(index);
-				}
-				// 要素へのIndexから、実際の要素の値を取得して、頂点を構築する
-				Vector4 position = positions[elementIndices[0] - 1];
-				Vector2 texcoord = texcoords[elementIndices[1] - 1];
-				Vector3 normal = normals[elementIndices[2] - 1];
-				triangle[faceVertex] = { position, texcoord, normal };
-			}
-			// 頂点を逆順で登録することで、周り順を逆にする
-			modelData.verticles.push_back(triangle[2]);
-			modelData.verticles.push_back(triangle[1]);
-			modelData.verticles.push_back(triangle[0]);
-		}
-		else if (identifier == "mtllib") {
-			// materialTemplateLibraryファイルの名前を取得する
-			string materialFilename;
-			s >> materialFilename;
-			// 基本的にobjファイルと同一改装にmtlは存在させるので、ディレクトリ名とファイル名を渡す
-			modelData.material = LoadMaterialTemplateFile(directoryPath, materialFilename);
-		}
-	}
-
-	return modelData;
-}
-
-SoundData SoundLoadWave(const char* filename) {
-	// ファイル入力ストリームのインスタンス
-	ifstream file;
-	// .wavファイルをバイナリモードで開く
-	file.open(filename, ios_base::binary);
-	// ファイルオープン失敗を検出する
-	assert(file.is_open());
+// メモリ上の.wavファイルの中身から音声データを読み込む
+SoundData SoundLoadWave(string_view contents) {
+	// 読み取り位置。ファイル入力ストリームの代わりに中身を前から読む
+	size_t position = 0;
+	auto read = [&](void* destination, size_t size) {
+		assert(position + size <= contents.size());
+		memcpy(destination, contents.data() + position, size);
+		position += size;
+	};
 
 	// RIFFヘッダーの読み込み
 	RiffHeader riff;
-	file.read((char*)&riff, sizeof(riff));
+	read(&riff, sizeof(riff));
 	// ファイルがRIFFかチェック
 	if (strncmp(riff.chunk.id, "RIFF", 4) != 0) {
 		assert(0);
@@ -548,24 +462,24 @@ SoundData SoundLoadWave(const char* filename) {
 	// Formatチャンクの読み込み
 	FormatChunk format = {};
 	// チャンクヘッダーの確認
-	file.read((char*)&format, sizeof(ChunkHeader));
+	read(&format, sizeof(ChunkHeader));
 	if (strncmp(format.chunk.id, "fmt ", 4) != 0) {
 		assert(0);
 	}
 
 	// チャンク本体の読み込み
 	assert(format.chunk.size <= sizeof(format.fmt));
-	file.read((char*)&format.fmt, format.chunk.size);
+	read(&format.fmt, format.chunk.size);
 
 	// Dataチャンクの読み込み
 	ChunkHeader data;
-	file.read((char*)&data, sizeof(data));
+	read(&data, sizeof(data));
 	// JUNKチャンクを検出した場合
 	if (strncmp(data.id, "JUNK", 4) == 0) {
 		// 読み取り位置をJUNKチャンクの終わりまで進める
-		file.seekg(data.size, ios_base::cur);
+		position += data.size;
 		// 再読み込み
-		file.read((char*)&data, sizeof(data));
+		read(&data, sizeof(data));
 	}
 
 	if (strncmp(data.id, "data", 4) != 0) {
@@ -574,10 +488,7 @@ SoundData SoundLoadWave(const char* filename) {
 
 	// Dataチャンクのデータ部（波形データ）の読み込み
 	char* pBuffer = new char[data.size];
-	file.read(pBuffer, data.size);
-
-	// Waveファイルを閉じる
-	file.close();
+	read(pBuffer, data.size);
 
 	// returnするためのデータ
 	SoundData soundData = {};
@@ -946,7 +857,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	descriptorRangeForInstancing[0].OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
 
 	// RootParameter作成
-	D3D12_ROOT_PARAMETER rootParametersForInstancing[4] = {};
+	D3D12_ROOT_PARAMETER rootParametersForInstancing[5] = {};
 	rootParametersForInstancing[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV; // CBVを使う
 	rootParametersForInstancing[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL; // PixelShaderで使う
 	rootParametersForInstancing[0].Descriptor.ShaderRegister = 0; // レジスタ番号0とバインド
@@ -961,6 +872,10 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	rootParametersForInstancing[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV; // CBVを使う
 	rootParametersForInstancing[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL; // PixelShaderで使う
 	rootParametersForInstancing[3].Descriptor.ShaderRegister = 1; // レジスタ番号1を使う
+	rootParametersForInstancing[4].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS; // 定数を直接置く
+	rootParametersForInstancing[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX; // VertexShaderで使う
+	rootParametersForInstancing[4].Constants.ShaderRegister = 0; // レジスタ番号0とバインド
+	rootParametersForInstancing[4].Constants.Num32BitValues = sizeof(VertexQuantization) / sizeof(uint32_t); // 頂点の量子化の係数
 	descriptionRootSignatureForInstancing.pParameters = rootParametersForInstancing; // ルートパラメータ配列へのポインタ
 	descriptionRootSignatureForInstancing.NumParameters = _countof(rootParametersForInstancing); // 配列の長さ
 
@@ -998,6 +913,24 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	inputLayoutDesc.pInputElementDescs = inputElementDescs;
 	inputLayoutDesc.NumElements = _countof(inputElementDescs);
 
+	// InputLayout(パーティクル用)。モデルの頂点はPackedVertexDataに圧縮して送る
+	D3D12_INPUT_ELEMENT_DESC inputElementDescsForInstancing[3] = {};
+	inputElementDescsForInstancing[0].SemanticName = "POSITION";
+	inputElementDescsForInstancing[0].SemanticIndex = 0;
+	inputElementDescsForInstancing[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	inputElementDescsForInstancing[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	inputElementDescsForInstancing[1].SemanticName = "NORMAL";
+	inputElementDescsForInstancing[1].SemanticIndex = 0;
+	inputElementDescsForInstancing[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	inputElementDescsForInstancing[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	inputElementDescsForInstancing[2].SemanticName = "TEXCOORD";
+	inputElementDescsForInstancing[2].SemanticIndex = 0;
+	inputElementDescsForInstancing[2].Format = DXGI_FORMAT_R16G16_FLOAT;
+	inputElementDescsForInstancing[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+	D3D12_INPUT_LAYOUT_DESC inputLayoutDescForInstancing{};
+	inputLayoutDescForInstancing.pInputElementDescs = inputElementDescsForInstancing;
+	inputLayoutDescForInstancing.NumElements = _countof(inputElementDescsForInstancing);
+
 	// BlendStateの設定
 	D3D12_BLEND_DESC blendDesc{};
 	// すべての色要素を書き込む
@@ -1062,7 +995,7 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDescForInstancing{};
 	graphicsPipelineStateDescForInstancing.pRootSignature = rootSignatureForInstancing.Get(); // RootSignature
-	graphicsPipelineStateDescForInstancing.InputLayout = inputLayoutDesc; // InputLayout
+	graphicsPipelineStateDescForInstancing.InputLayout = inputLayoutDescForInstancing; // InputLayout
 	graphicsPipelineStateDescForInstancing.VS = { vertexShaderBlobForInstancing->GetBufferPointer(),
 	vertexShaderBlobForInstancing->GetBufferSize() }; // VertexShader
 	graphicsPipelineStateDescForInstancing.PS = { pixelShaderBlobForInstancing->GetBufferPointer(),
@@ -1092,26 +1025,63 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	modelData.verticles.push_back({ .position = {1.0f, 1.0f, 0.0f, 1.0f}, .texcoord = {0.0f, 0.0f}, .normal = {0.0f, 0.0f, 1.0f} });
 	modelData.verticles.push_back({ .position = {-1.0f, 1.0f, 0.0f, 1.0f}, .texcoord = {1.0f, 0.0f}, .normal = {0.0f, 0.0f, 1.0f} });
 	modelData.verticles.push_back({ .position = {1.0f, -1.0f, 0.0f, 1.0f}, .texcoord = {0.0f, 1.0f}, .normal = {0.0f, 0.0f, 1.0f} });
-	modelData.verticles.push_back({ .position = {1.0f, -1.0f, 0.0f, 1.0f}, .texcoord = {0.0f, 1.0f}, .normal = {0.0f, 0.0f, 1.0f} });
-	modelData.verticles.push_back({ .position = {-1.0f, 1.0f, 0.0f, 1.0f}, .texcoord = {1.0f, 0.0f}, .normal = {0.0f, 0.0f, 1.0f} });
 	modelData.verticles.push_back({ .position = {-1.0f, -1.0f, 0.0f, 1.0f}, .texcoord = {1.0f, 1.0f}, .normal = {0.0f, 0.0f, 1.0f} });
+	modelData.indices = { 0, 1, 2, 2, 1, 3 };
 	modelData.material.textureFilePath = "./resources/uvChecker.png";
+	modelData.materials = { modelData.material };
+	modelData.submeshes = { { "", 0, UINT(modelData.indices.size()), 0 } };
+	// カリングやLODの選択で使う境界を求めておく
+	ComputeModelBounds(modelData);
+	// 遠くを描くときの簡略化したLODを作る。LODのIndexはmodelData.indicesの後ろに足される
+	std::vector<MeshLod> modelLods = BuildLodChain(modelData);
+	// LODごとにメッシュレットに分け、見えないまとまりを描かずに済むようにする
+	std::vector<MeshletData> modelMeshlets;
+	for (const MeshLod& lod : modelLods) {
+		modelMeshlets.push_back(BuildMeshlets(modelData, lod.submeshes));
+	}
+	// 頂点を16バイトに圧縮する。位置は境界箱の中で量子化するので、戻すための係数をシェーダーへ渡す
+	const VertexQuantization vertexQuantization = MakeVertexQuantization(modelData.bounds.aabb);
+	std::vector<PackedVertexData> packedVertices = PackVertices(modelData.verticles, vertexQuantization);
 	// 頂点リソースを作る
-	ComPtr<ID3D12Resource> vertexResource = CreateBufferResource(device, sizeof(VertexData) * modelData.verticles.size());
+	ComPtr<ID3D12Resource> vertexResource = CreateBufferResource(device, sizeof(PackedVertexData) * packedVertices.size());
 	// 頂点バッファビューを作成する
 	D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
 	// リソースの先頭のアドレスから使う
 	vertexBufferView.BufferLocation = vertexResource->GetGPUVirtualAddress();
 	// 使用するリソースのサイズは頂点のサイズ
-	vertexBufferView.SizeInBytes = UINT(sizeof(VertexData) * modelData.verticles.size());
+	vertexBufferView.SizeInBytes = UINT(sizeof(PackedVertexData) * packedVertices.size());
 	// 1頂点あたりのサイズ
-	vertexBufferView.StrideInBytes = sizeof(VertexData);
+	vertexBufferView.StrideInBytes = sizeof(PackedVertexData);
 
 	// 頂点リソースにデータを書き込む
-	VertexData* vertexData = nullptr;
+	PackedVertexData* vertexData = nullptr;
 	// 書き込むためのアドレスを取得
 	vertexResource->Map(0, nullptr, reinterpret_cast<void**>(&vertexData));
-	memcpy(vertexData, modelData.verticles.data(), sizeof(VertexData) * modelData.verticles.size());
+	memcpy(vertexData, packedVertices.data(), sizeof(PackedVertexData) * packedVertices.size());
+
+	// Index用のリソースを作る。頂点数が少なければ16bitのIndexにする
+	const bool useIndex16 = CanUse16BitIndices(modelData);
+	const size_t indexSize = useIndex16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	ComPtr<ID3D12Resource> indexResource = CreateBufferResource(device, indexSize * modelData.indices.size());
+	D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+	// リソースの先頭のアドレスから使う
+	indexBufferView.BufferLocation = indexResource->GetGPUVirtualAddress();
+	// 使用するリソースのサイズはIndexの数分のサイズ
+	indexBufferView.SizeInBytes = UINT(indexSize * modelData.indices.size());
+	// Indexの型
+	indexBufferView.Format = useIndex16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+	// Indexリソースにデータを書き込む
+	void* indexData = nullptr;
+	indexResource->Map(0, nullptr, &indexData);
+	if (useIndex16) {
+		uint16_t* indexData16 = static_cast<uint16_t*>(indexData);
+		for (size_t i = 0; i < modelData.indices.size(); ++i) {
+			indexData16[i] = uint16_t(modelData.indices[i]);
+		}
+	} else {
+		memcpy(indexData, modelData.indices.data(), sizeof(uint32_t) * modelData.indices.size());
+	}
 
 	// 数学関数
 	Matrix* matrix = new Matrix;
@@ -1232,16 +1202,38 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// WVP用のリソースを作る
 	ComPtr<ID3D12Resource> wvpResource = CreateBufferResource(device, sizeof(TransformationMatrix));
 
-	Particle particles[kNumInstance];
+	// パーティクルの座標変換は成分ごとの配列で持つ
+	TransformArray particleTransforms;
+	particleTransforms.Resize(kNumInstance);
+	Vector3 particleVelocities[kNumInstance];
 	for (uint32_t index = 0; index < kNumInstance; ++index) {
 		// 位置と速度を[-1,1]でランダムに初期化
-		particles[index] = MakeNewParticle(randomEngine);
+		Particle particle = MakeNewParticle(randomEngine);
+		particleTransforms.Set(index, particle.transform);
+		particleVelocities[index] = particle.velocity;
+	}
+	// カリング用の境界球の半径。球はインスタンスの位置を中心にするので、モデルの境界球の中心のずれの分だけ広げる
+	float particleRadii[kNumInstance];
+	const float modelRadius = Length(modelData.bounds.sphere.center) + modelData.bounds.sphere.radius;
+	for (uint32_t index = 0; index < kNumInstance; ++index) {
+		float maxScale = (std::max)({ particleTransforms.scale.x[index], particleTransforms.scale.y[index], particleTransforms.scale.z[index] });
+		particleRadii[index] = modelRadius * maxScale;
 	}
+	uint8_t particleVisible[kNumInstance];
+	// 描画するインスタンス数
+	uint32_t numVisibleInstance = kNumInstance;
+	// 描画するLOD
+	size_t modelLod = 0;
+	// 選んだLODのメッシュレットのうち見えているものと、それをまとめた描画範囲
+	std::vector<uint8_t> meshletVisible;
+	std::vector<SubmeshData> modelDrawRanges;
 
 	// Δtを設定
 	const float kDeltaTime = 1.0f / 60.0f;
 
-	Transform cameraTransform{ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 4.0f, 10.0f} };
+	// カメラ
+	Camera* camera = new Camera();
+	camera->Initialize({ {1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 4.0f, 10.0f} }, float(WinApp::kClientWidth) / float(WinApp::kClientHeight));
 
 	// データを書き込む
 	TransformationMatrix* wvpData = nullptr;
@@ -1275,46 +1267,50 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 0),
 		GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 0));
 
-	// Texture
-	ScratchImage mipImages = LoadTexture("resources/uvChecker.png");
-	const TexMetadata& metadata = mipImages.GetMetadata();
-	ComPtr<ID3D12Resource> textureResource = CreateTextureResource(device, metadata);
-	ComPtr<ID3D12Resource> intermediateResource = UploadTextureData(textureResource, mipImages, device, commandList);
-
-	// 2枚目のTextureを読んで転送する
-	ScratchImage mipImages2 = LoadTexture(modelData.material.textureFilePath);
-	const TexMetadata& metadata2 = mipImages2.GetMetadata();
-	ComPtr<ID3D12Resource> textureResource2 = CreateTextureResource(device, metadata2);
-	ComPtr<ID3D12Resource> intermediateResource2 = UploadTextureData(textureResource2, mipImages2, device, commandList);
-
-	// metadataを基にSRVの設定
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-	srvDesc.Format = metadata.format;
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
-	srvDesc.Texture2D.MipLevels = UINT(metadata.mipLevels);
-
-	// SRVを作成するDescriptoHeapの場所を決める
-	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 0);
-	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 0);
-	// 先頭はImGuiが使っているのでその次を使う
-	textureSrvHandleCPU.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	textureSrvHandleGPU.ptr += device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	// SRVの生成
-	device->CreateShaderResourceView(textureResource.Get(), &srvDesc, textureSrvHandleCPU);
-
-	// metadataを基にSRVの設定
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc2{};
-	srvDesc2.Format = metadata2.format;
-	srvDesc2.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc2.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
-	srvDesc2.Texture2D.MipLevels = UINT(metadata2.mipLevels);
-
-	// SRVを作成するDescriptoHeapの場所を決める
+	// アセットは別スレッドで読み込み、終わるまでは1x1の白いテクスチャを代わりに使う
+	// ワーカースレッドでもWICを使うのでCOMを初期化する
+	AssetLoader assetLoader(0, []() { CoInitializeEx(0, COINIT_MULTITHREADED); }, []() { CoUninitialize(); });
+	// 転送が終わるまで中間リソースを生かしておく
+	vector<ComPtr<ID3D12Resource>> pendingUploads;
+	// 同じファイルのアセットは1度だけ読み込んで共有する
+	AssetRegistry<TextureData> textureRegistry([](const TextureData& texture) { return texture.memorySize; }, kTextureMemoryBudget);
+	AssetRegistry<SoundData> soundRegistry([](const SoundData& soundData) { return size_t(soundData.bufferSize); }, kSoundMemoryBudget,
+		[](SoundData& soundData) { SoundUnload(&soundData); });
+
+	ScratchImage placeholderImage = MakePlaceholderTexture();
+	ComPtr<ID3D12Resource> placeholderResource = CreateTextureResource(device, placeholderImage.GetMetadata());
+	pendingUploads.push_back(UploadTextureData(placeholderResource, placeholderImage, device, commandList));
+
+	// SRVを作成するDescriptoHeapの場所を決める。先頭はImGuiが使っているのでその次を使う
+	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
+	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 1);
 	D3D12_CPU_DESCRIPTOR_HANDLE textureSrvHandleCPU2 = GetCPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
 	D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandleGPU2 = GetGPUDescriptorHandle(srvDescriptorHeap, descriptorSizeSRV, 2);
-	// SRVの生成
-	device->CreateShaderResourceView(textureResource2.Get(), &srvDesc2, textureSrvHandleCPU2);
+	CreateTextureSrv(device, placeholderResource, placeholderImage.GetMetadata(), textureSrvHandleCPU);
+	CreateTextureSrv(device, placeholderResource, placeholderImage.GetMetadata(), textureSrvHandleCPU2);
+
+	// Textureを読み込み、終わったらsrvHandleCPUのSRVを差し替える
+	// 読み込みはワーカースレッドで、転送は初めて読み込んだときだけメインスレッドで行う
+	auto requestTexture = [&](const string& filePath, D3D12_CPU_DESCRIPTOR_HANDLE srvHandleCPU, AssetRegistry<TextureData>::Handle& texture) {
+		textureRegistry.LoadAsync(assetLoader, filePath,
+			[](const string&, string_view contents) { return LoadTexture(contents); },
+			[&](ScratchImage&& mipImages) {
+				TextureData created = { CreateTextureResource(device, mipImages.GetMetadata()), mipImages.GetMetadata(), mipImages.GetPixelsSize() };
+				pendingUploads.push_back(UploadTextureData(created.resource, mipImages, device, commandList));
+				return created;
+			},
+			[&, srvHandleCPU, target = &texture](const AssetRegistry<TextureData>::Handle& loaded) {
+				*target = loaded;
+				CreateTextureSrv(device, loaded->resource, loaded->metadata, srvHandleCPU);
+			});
+	};
+
+	// Texture
+	AssetRegistry<TextureData>::Handle texture;
+	requestTexture("resources/uvChecker.png", textureSrvHandleCPU, texture);
+	// 2枚目のTexture。同じファイルなら1枚目と同じリソースを指すSRVになる
+	AssetRegistry<TextureData>::Handle texture2;
+	requestTexture(modelData.material.textureFilePath, textureSrvHandleCPU2, texture2);
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC instancingSrvDesc{};
 	instancingSrvDesc.Format = DXGI_FORMAT_UNKNOWN;
@@ -1342,10 +1338,18 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	// マスターボイスを生成
 	result = xAudio2->CreateMasteringVoice(&masterVoice);
 
-	// 音声読み込み
-	SoundData soundData1 = SoundLoadWave("resources/Alarm01.wav");
-	// 音声再生
-	SoundPlayWave(xAudio2.Get(), soundData1);
+	// 音声読み込み。読み込みが終わったら再生する
+	AssetRegistry<SoundData>::Handle soundData1;
+	soundRegistry.LoadAsync(assetLoader, "resources/Alarm01.wav",
+		[](const string&, string_view contents) { return SoundLoadWave(contents); },
+		[](SoundData&& soundData) { return soundData; },
+		[&](const AssetRegistry<SoundData>::Handle& loaded) {
+			soundData1 = loaded;
+			// 音声再生
+			SoundPlayWave(xAudio2.Get(), *soundData1);
+		},
+		// 同じ中身の音声が登録済みだったときや、再生前に終了したときはバッファを解放する
+		[](SoundData& soundData) { SoundUnload(&soundData); });
 
 	// ブレンドモード
 	static int currentBlend = kBlendModeNone;
@@ -1362,6 +1366,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			break;
 		}
 
+		// 読み込みが終わったアセットを反映する
+		assetLoader.Update();
+
 		// ゲームの処理
 		ImGui_ImplDX12_NewFrame();
 		ImGui_ImplWin32_NewFrame();
@@ -1430,7 +1437,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 		if (canUpdate) {
 			for (uint32_t index = 0; index < kNumInstance; index++) {
-				particles[index].transform.translate += particles[index].velocity * kDeltaTime;
+				particleTransforms.translate.x[index] += particleVelocities[index].x * kDeltaTime;
+				particleTransforms.translate.y[index] += particleVelocities[index].y * kDeltaTime;
+				particleTransforms.translate.z[index] += particleVelocities[index].z * kDeltaTime;
 			}
 		}
 
@@ -1466,13 +1475,18 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		commandList->SetDescriptorHeaps(1, descriptorHeaps->GetAddressOf());
 
 		ImGui::Begin("Setting");
-		ImGui::DragFloat3("cameraTranslate", &cameraTransform.translate.x, 0.01f);
-		ImGui::SliderAngle("CameraRotateX", &cameraTransform.rotate.x, 0.01f);
-		ImGui::SliderAngle("CameraRotateY", &cameraTransform.rotate.y, 0.01f);
-		ImGui::SliderAngle("CameraRotateZ", &cameraTransform.rotate.z, 0.01f);
-		ImGui::SliderAngle("SphereRotateX", &particles[0].transform.rotate.x, 0.01f);
-		ImGui::SliderAngle("SphereRotateY", &particles[0].transform.rotate.y, 0.01f);
-		ImGui::SliderAngle("SphereRotateZ", &particles[0].transform.rotate.z, 0.01f);
+		// カメラは値が変わった時だけ設定し直す
+		Transform cameraTransform = camera->GetTransform();
+		bool isCameraChanged = ImGui::DragFloat3("cameraTranslate", &cameraTransform.translate.x, 0.01f);
+		isCameraChanged |= ImGui::SliderAngle("CameraRotateX", &cameraTransform.rotate.x, 0.01f);
+		isCameraChanged |= ImGui::SliderAngle("CameraRotateY", &cameraTransform.rotate.y, 0.01f);
+		isCameraChanged |= ImGui::SliderAngle("CameraRotateZ", &cameraTransform.rotate.z, 0.01f);
+		if (isCameraChanged) {
+			camera->SetTransform(cameraTransform);
+		}
+		ImGui::SliderAngle("SphereRotateX", &particleTransforms.rotate.x[0], 0.01f);
+		ImGui::SliderAngle("SphereRotateY", &particleTransforms.rotate.y[0], 0.01f);
+		ImGui::SliderAngle("SphereRotateZ", &particleTransforms.rotate.z[0], 0.01f);
 		ImGui::ColorEdit4("color", &materialData->color.x);
 		ImGui::CheckboxFlags("enableLighting", &materialData->enableLighting, 1);
 		ImGui::CheckboxFlags("update", &canUpdate, 1);
@@ -1509,14 +1523,19 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 		// Modelの描画
 		commandList->IASetVertexBuffers(0, 1, &vertexBufferView);
+		commandList->IASetIndexBuffer(&indexBufferView); // IBVを設定
 		// マテリアルCBufferの場所を設定
 		commandList->SetGraphicsRootConstantBufferView(0, materialResource->GetGPUVirtualAddress());
 		// instancing用のDataを読み込むためにStructuredBufferのSRVを設定する
 		commandList->SetGraphicsRootDescriptorTable(1, instancingSrvHandleGPU);
+		// 頂点の量子化の係数を設定
+		commandList->SetGraphicsRoot32BitConstants(4, sizeof(VertexQuantization) / sizeof(uint32_t), &vertexQuantization, 0);
 		// SRVのDescriptorTableの先頭を設定。2はrootParameter[2]である。
 		commandList->SetGraphicsRootDescriptorTable(2, useMonsterBall ? textureSrvHandleGPU2 : textureSrvHandleGPU);
-		// 描画
-		commandList->DrawInstanced(UINT(modelData.verticles.size()), kNumInstance, 0, 0);
+		// 描画。選んだLODの見えているメッシュレットをまとめた範囲ごとに描く
+		for (const SubmeshData& submesh : modelDrawRanges) {
+			commandList->DrawIndexedInstanced(submesh.indexCount, numVisibleInstance, submesh.indexOffset, 0, 0);
+		}
 
 		commandList->IASetIndexBuffer(&indexBufferViewSprite); // IBVを設定
 		// RootSignatureを設定
@@ -1567,6 +1586,11 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			// イベント待つ
 			WaitForSingleObject(fenceEvent, INFINITE);
 		}
+		// 転送が終わったので中間リソースを解放する
+		pendingUploads.clear();
+		// GPUが使い終わったので、手放されたアセットを予算に収まるまで捨てる
+		textureRegistry.Trim();
+		soundRegistry.Trim();
 
 		// 次のフレーム用のコマンドリストを準備
 		hr = commandAllocator->Reset();
@@ -1575,17 +1599,42 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		assert(SUCCEEDED(hr));
 
 		// Model用のWVPMatrixを作る
+		camera->Update();
+		// 視錐台の外にあるインスタンスを除く
+		Frustum frustum = MakeFrustum(camera->GetViewProjectionMatrix());
+		CullSpheres(frustum, particleTransforms.translate.x, particleTransforms.translate.y, particleTransforms.translate.z, particleRadii, particleVisible);
+		// 見えているインスタンスのWorldとWVPだけを作り、instancingDataへ前から詰めて直接書き込む
+		numVisibleInstance = uint32_t(particleTransforms.BuildWorldMatrices({ instancingData, kNumInstance }, camera->GetViewProjectionMatrix(), particleVisible));
+		// 全インスタンスを1回で描くので、一番近い見えているインスタンスの画面上の大きさでLODを選ぶ
+		float nearestDistance = INFINITY;
+		for (uint32_t index = 0; index < kNumInstance; ++index) {
+			if (particleVisible[index]) {
+				Vector3 translate = { particleTransforms.translate.x[index], particleTransforms.translate.y[index], particleTransforms.translate.z[index] };
+				float maxScale = (std::max)({ particleTransforms.scale.x[index], particleTransforms.scale.y[index], particleTransforms.scale.z[index] });
+				nearestDistance = (std::min)(nearestDistance, Length(translate - camera->GetTransform().translate) / maxScale);
+			}
+		}
+		modelLod = SelectLod(modelLods, nearestDistance, camera->GetProjectionMatrix(), float(WinApp::kClientHeight));
+		// 見えているインスタンスごとに視錐台とカメラをモデル空間へ移してメッシュレットをカリングし、
+		// どれかのインスタンスで見えているメッシュレットだけを描く
+		const MeshletData& meshlets = modelMeshlets[modelLod];
+		meshletVisible.assign(meshlets.meshlets.size(), 0);
 		for (uint32_t index = 0; index < kNumInstance; ++index) {
-			Matrix4x4 worldMatrix = matrix->MakeAffineMatrix(particles[index].transform.scale, particles[index].transform.rotate, particles[index].transform.translate);
-			Matrix4x4 cameraMatrix = matrix->MakeAffineMatrix(cameraTransform.scale, cameraTransform.rotate, cameraTransform.translate);
-			Matrix4x4 viewMatrix = matrix->Inverse(cameraMatrix);
-			Matrix4x4 projectionMatrix = matrix->MakePerspectiveFovMatrix(0.45f, float(WinApp::kClientWidth) / float(WinApp::kClientHeight), 0.1f, 100.0f);
-			Matrix4x4 wvpMatrix = matrix->Multiply(worldMatrix, matrix->Multiply(viewMatrix, projectionMatrix));
-			instancingData[index] = { wvpMatrix, worldMatrix };
+			if (particleVisible[index]) {
+				Matrix4x4 worldMatrix = MakeTransformMatrix(particleTransforms.Get(index));
+				Matrix4x4 inverseWorld = matrix->InverseAffine(worldMatrix);
+				const Vector3& cameraTranslate = camera->GetTransform().translate;
+				Vector3 cameraPosition = {
+					cameraTranslate.x * inverseWorld.m[0][0] + cameraTranslate.y * inverseWorld.m[1][0] + cameraTranslate.z * inverseWorld.m[2][0] + inverseWorld.m[3][0],
+					cameraTranslate.x * inverseWorld.m[0][1] + cameraTranslate.y * inverseWorld.m[1][1] + cameraTranslate.z * inverseWorld.m[2][1] + inverseWorld.m[3][1],
+					cameraTranslate.x * inverseWorld.m[0][2] + cameraTranslate.y * inverseWorld.m[1][2] + cameraTranslate.z * inverseWorld.m[2][2] + inverseWorld.m[3][2],
+				};
+				CullMeshlets(meshlets, MakeFrustum(worldMatrix * camera->GetViewProjectionMatrix()), cameraPosition, meshletVisible);
+			}
 		}
-
+		BuildMeshletDrawRanges(meshlets, meshletVisible, modelDrawRanges);
 		// Sprite用のWorldViewProjectionMatrixを作る
-		Matrix4x4 worldMatrixSprite = matrix->MakeAffineMatrix(transformSprite.scale, transformSprite.rotate, transformSprite.translate);
+		Matrix4x4 worldMatrixSprite = MakeTransformMatrix(transformSprite);
 		Matrix4x4 viewMatrixSprite = matrix->MakeIdentity4x4();
 		Matrix4x4 projectionMatrixSprite = matrix->MakeOrthographicMatrix(0.0f, 0.0f, float(WinApp::kClientWidth), float(WinApp::kClientHeight), 0.0f, 100.0f);
 		Matrix4x4 wvpMatrixSprite = matrix->Multiply(worldMatrixSprite, matrix->Multiply(viewMatrixSprite, projectionMatrixSprite));
@@ -1608,13 +1657,16 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	// 数学関数解放
 	delete matrix;
+	// カメラ解放
+	delete camera;
 	// キー入力処理解放
 	delete input;
 
 	// XAudio2解放
 	xAudio2.Reset();
 	// 音声データ解放
-	SoundUnload(&soundData1);
+	soundData1 = nullptr;
+	soundRegistry.Clear();
 
 	// ImGuiの終了処理
 	ImGui_ImplDX12_Shutdown();
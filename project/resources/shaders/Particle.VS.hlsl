@@ -7,16 +7,34 @@ struct TransformationMatrix {
 
 StructuredBuffer<TransformationMatrix> gTransformationMatrices : register(t0);
 
+// 量子化した位置をモデル空間へ戻す係数
+struct VertexQuantization {
+    float32_t3 offset;
+    float32_t3 scale;
+};
+
+ConstantBuffer<VertexQuantization> gVertexQuantization : register(b0);
+
+// 圧縮した頂点。位置は境界箱の中の[0,1]、法線は八面体に展開した[-1,1]の2次元
 struct VertexShaderInput {
     float32_t4 position : POSITION0;
     float32_t2 texcoord : TEXCOORD0;
-    float32_t3 normal : NORMAL0;
+    float32_t2 normal : NORMAL0;
 };
 
+float32_t3 DecodeOctahedral(float32_t2 encoded) {
+    float32_t3 normal = float32_t3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0f) {
+        normal.xy = (1.0f - abs(encoded.yx)) * ((encoded >= 0.0f) * 2.0f - 1.0f);
+    }
+    return normalize(normal);
+}
+
 VertexShaderOutput main(VertexShaderInput input, uint32_t instanceId : SV_InstanceID) {
     VertexShaderOutput output;
-    output.position = mul(input.position, gTransformationMatrices[instanceId].WVP);
+    float32_t4 position = float32_t4(input.position.xyz * gVertexQuantization.scale + gVertexQuantization.offset, 1.0f);
+    output.position = mul(position, gTransformationMatrices[instanceId].WVP);
     output.texcoord = input.texcoord;
-    output.normal = normalize(mul(input.normal, (float32_t3x3) gTransformationMatrices[instanceId].World));
+    output.normal = normalize(mul(DecodeOctahedral(input.normal), (float32_t3x3) gTransformationMatrices[instanceId].World));
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,676 @@
+// 数学ライブラリのベンチマークと精度検証
+// engine/mathだけに依存するので、Windows以外でも以下のようにビルドできる
+//   g++ -std=c++20 -O2 -I../../engine/math main.cpp ../../engine/math/*.cpp
+// 各項目の1回あたりの時間(ns/op)と、doubleで計算した参照値との誤差(ULP)を出力する
+// 誤差が許容値を超えた項目があれば終了コード1を返す
+#include "Geometry.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "TransformArray.h"
+#include "TransformMatrix.h"
+#include "Vector3A.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 入力データの数（2の累乗）
+const size_t kNumInputs = 1024;
+// 計測の繰り返し回数
+const size_t kNumIterations = 1 << 20;
+// 計測を行う回数。一番速かった結果を使う
+const int kNumTrials = 5;
+
+// 最適化で計算が消されないように結果を足し込む
+volatile float gSink = 0.0f;
+
+// doubleの4x4行列（参照実装用）
+struct Matrix4x4d {
+	double m[4][4];
+};
+
+Matrix4x4d ToDouble(const Matrix4x4& m) {
+	Matrix4x4d result;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			result.m[row][column] = m.m[row][column];
+		}
+	}
+	return result;
+}
+
+Matrix4x4d MultiplyD(const Matrix4x4d& m1, const Matrix4x4d& m2) {
+	Matrix4x4d result = {};
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			for (int k = 0; k < 4; k++) {
+				result.m[row][column] += m1.m[row][k] * m2.m[k][column];
+			}
+		}
+	}
+	return result;
+}
+
+// 部分ピボット選択付きのガウス・ジョルダン法
+Matrix4x4d InverseD(const Matrix4x4d& m) {
+	double a[4][8];
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			a[row][column] = m.m[row][column];
+			a[row][column + 4] = row == column ? 1.0 : 0.0;
+		}
+	}
+	for (int column = 0; column < 4; column++) {
+		int pivot = column;
+		for (int row = column + 1; row < 4; row++) {
+			if (abs(a[row][column]) > abs(a[pivot][column])) {
+				pivot = row;
+			}
+		}
+		swap(a[column], a[pivot]);
+		const double inv = 1.0 / a[column][column];
+		for (int k = 0; k < 8; k++) {
+			a[column][k] *= inv;
+		}
+		for (int row = 0; row < 4; row++) {
+			if (row != column) {
+				const double factor = a[row][column];
+				for (int k = 0; k < 8; k++) {
+					a[row][k] -= factor * a[column][k];
+				}
+			}
+		}
+	}
+	Matrix4x4d result;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			result.m[row][column] = a[row][column + 4];
+		}
+	}
+	return result;
+}
+
+// S * Rx * Ry * Rz * T を行列の積で作る
+Matrix4x4d MakeAffineMatrixD(const Vector3& scale, const Vector3& rotate, const Vector3& translate) {
+	const double sx = sin(double(rotate.x)), cx = cos(double(rotate.x));
+	const double sy = sin(double(rotate.y)), cy = cos(double(rotate.y));
+	const double sz = sin(double(rotate.z)), cz = cos(double(rotate.z));
+	Matrix4x4d s = { scale.x, 0, 0, 0, 0, scale.y, 0, 0, 0, 0, scale.z, 0, 0, 0, 0, 1 };
+	Matrix4x4d rx = { 1, 0, 0, 0, 0, cx, sx, 0, 0, -sx, cx, 0, 0, 0, 0, 1 };
+	Matrix4x4d ry = { cy, 0, -sy, 0, 0, 1, 0, 0, sy, 0, cy, 0, 0, 0, 0, 1 };
+	Matrix4x4d rz = { cz, sz, 0, 0, -sz, cz, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+	Matrix4x4d t = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, translate.x, translate.y, translate.z, 1 };
+	return MultiplyD(s, MultiplyD(rx, MultiplyD(ry, MultiplyD(rz, t))));
+}
+
+Matrix4x4d MakePerspectiveFovMatrixD(double fovY, double aspectRatio, double nearClip, double farClip) {
+	const double cot = 1.0 / tan(fovY / 2.0);
+	return { cot / aspectRatio, 0, 0, 0,
+			 0, cot, 0, 0,
+			 0, 0, farClip / (farClip - nearClip), 1,
+			 0, 0, -nearClip * farClip / (farClip - nearClip), 0 };
+}
+
+Matrix4x4d MakeOrthographicMatrixD(double left, double top, double right, double bottom, double nearClip, double farClip) {
+	return { 2.0 / (right - left), 0, 0, 0,
+			 0, 2.0 / (top - bottom), 0, 0,
+			 0, 0, 1.0 / (farClip - nearClip), 0,
+			 (left + right) / (left - right), (top + bottom) / (bottom - top), nearClip / (nearClip - farClip), 1 };
+}
+
+// 参照値との誤差をULP単位で求める
+// 打ち消しで0付近になる成分の誤差が大きく見えないよう、scale（行の最大絶対値など）の1ULPを単位にする
+double UlpError(double value, double reference, double scale) {
+	const float magnitude = max(float(abs(scale)), numeric_limits<float>::min());
+	const double ulp = double(nextafter(magnitude, numeric_limits<float>::infinity())) - double(magnitude);
+	return abs(value - reference) / ulp;
+}
+
+double UlpError(const Matrix4x4& value, const Matrix4x4d& reference) {
+	double result = 0.0;
+	for (int row = 0; row < 4; row++) {
+		double scale = 0.0;
+		for (int column = 0; column < 4; column++) {
+			scale = max(scale, abs(reference.m[row][column]));
+		}
+		for (int column = 0; column < 4; column++) {
+			result = max(result, UlpError(value.m[row][column], reference.m[row][column], scale));
+		}
+	}
+	return result;
+}
+
+// 行列の積の誤差。各成分の単位は |m1| * |m2| の対応する成分の1ULPにする
+double UlpErrorOfProduct(const Matrix4x4& value, const Matrix4x4d& m1, const Matrix4x4d& m2) {
+	const Matrix4x4d reference = MultiplyD(m1, m2);
+	double result = 0.0;
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			double scale = 0.0;
+			for (int k = 0; k < 4; k++) {
+				scale += abs(m1.m[row][k] * m2.m[k][column]);
+			}
+			result = max(result, UlpError(value.m[row][column], reference.m[row][column], scale));
+		}
+	}
+	return result;
+}
+
+double UlpError(const Vector3& value, double x, double y, double z) {
+	const double scale = max({ abs(x), abs(y), abs(z) });
+	return max({ UlpError(value.x, x, scale), UlpError(value.y, y, scale), UlpError(value.z, z, scale) });
+}
+
+// 外積の誤差。打ち消しの影響を除くため、各成分の単位は2つの項の絶対値の和の1ULPにする
+double UlpErrorOfCross(const Vector3& value, const Vector3& a, const Vector3& b) {
+	const double ax = a.x, ay = a.y, az = a.z, bx = b.x, by = b.y, bz = b.z;
+	return max({ UlpError(value.x, ay * bz - az * by, abs(ay * bz) + abs(az * by)),
+				 UlpError(value.y, az * bx - ax * bz, abs(az * bx) + abs(ax * bz)),
+				 UlpError(value.z, ax * by - ay * bx, abs(ax * by) + abs(ay * bx)) });
+}
+
+// funcをkNumIterations回呼んだときの1回あたりの時間(ns)
+template <typename Func>
+double Measure(Func&& func, size_t iterations = kNumIterations) {
+	double best = numeric_limits<double>::max();
+	for (int trial = 0; trial < kNumTrials; trial++) {
+		auto start = chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; i++) {
+			func(i & (kNumInputs - 1));
+		}
+		auto end = chrono::steady_clock::now();
+		best = min(best, chrono::duration<double, nano>(end - start).count() / double(iterations));
+	}
+	return best;
+}
+
+// 結果の表示
+int gNumFailed = 0;
+void Report(const char* name, double nanoseconds, double ulp, double tolerance) {
+	const bool failed = ulp > tolerance;
+	gNumFailed += failed ? 1 : 0;
+	printf("%-40s %10.2f ns/op %12.2f ulp (<= %6.0f) %s\n", name, nanoseconds, ulp, tolerance, failed ? "NG" : "OK");
+}
+void Report(const char* name, double nanoseconds) {
+	printf("%-40s %10.2f ns/op\n", name, nanoseconds);
+}
+
+// 時間を計らない精度だけの検査
+void ReportAccuracy(const char* name, double ulp, double tolerance) {
+	const bool failed = ulp > tolerance;
+	gNumFailed += failed ? 1 : 0;
+	printf("%-40s %16s %12.2f ulp (<= %6.0f) %s\n", name, "", ulp, tolerance, failed ? "NG" : "OK");
+}
+// 誤差を持たない検査
+void Check(const char* name, bool passed) {
+	gNumFailed += passed ? 0 : 1;
+	printf("%-40s %s\n", name, passed ? "OK" : "NG");
+}
+
+// ベクトル演算がコンパイル時に評価できること
+static_assert(Vector2{ 1.0f, 2.0f } + Vector2{ 3.0f, 4.0f } == Vector2{ 4.0f, 6.0f });
+static_assert(Vector2{ 1.0f, 2.0f } - Vector2{ 3.0f, 5.0f } == Vector2{ -2.0f, -3.0f });
+static_assert(Vector2{ 1.0f, 2.0f } * 2.0f == 2.0f * Vector2{ 1.0f, 2.0f });
+static_assert(Vector2{ 2.0f, 4.0f } / 2.0f == Vector2{ 1.0f, 2.0f });
+static_assert(-Vector2{ 1.0f, -2.0f } == Vector2{ -1.0f, 2.0f });
+static_assert(Dot(Vector2{ 1.0f, 2.0f }, Vector2{ 3.0f, 4.0f }) == 11.0f);
+static_assert(Cross(Vector2{ 1.0f, 0.0f }, Vector2{ 0.0f, 1.0f }) == 1.0f);
+static_assert(Vector3{ 1.0f, 2.0f, 3.0f } * Vector3{ 2.0f, 3.0f, 4.0f } == Vector3{ 2.0f, 6.0f, 12.0f });
+static_assert(Cross(Vector3{ 1.0f, 0.0f, 0.0f }, Vector3{ 0.0f, 1.0f, 0.0f }) == Vector3{ 0.0f, 0.0f, 1.0f });
+static_assert(LengthSquared(Vector3{ 1.0f, 2.0f, 2.0f }) == 9.0f);
+static_assert(Vector4{ 1.0f, 2.0f, 3.0f, 4.0f } + Vector4{ 4.0f, 3.0f, 2.0f, 1.0f } == Vector4{ 5.0f, 5.0f, 5.0f, 5.0f });
+static_assert(Vector4{ 1.0f, 2.0f, 3.0f, 4.0f } - Vector4{ 1.0f, 1.0f, 1.0f, 1.0f } == Vector4{ 0.0f, 1.0f, 2.0f, 3.0f });
+static_assert(Dot(Vector4{ 1.0f, 2.0f, 3.0f, 4.0f }, Vector4{ 1.0f, 1.0f, 1.0f, 1.0f }) == 10.0f);
+static_assert(Lerp(Vector2{ 0.0f, 2.0f }, Vector2{ 4.0f, 6.0f }, 0.5f) == Vector2{ 2.0f, 4.0f });
+static_assert(Lerp(Vector3{ 0.0f, 0.0f, 0.0f }, Vector3{ 4.0f, 8.0f, 12.0f }, 0.25f) == Vector3{ 1.0f, 2.0f, 3.0f });
+static_assert(Lerp(Vector4{ 1.0f, 1.0f, 1.0f, 1.0f }, Vector4{ 3.0f, 3.0f, 3.0f, 3.0f }, 1.0f) == Vector4{ 3.0f, 3.0f, 3.0f, 3.0f });
+static_assert([] {
+	Vector3 v = { 1.0f, 2.0f, 3.0f };
+	v += Vector3{ 1.0f, 1.0f, 1.0f };
+	v -= Vector3{ 0.0f, 1.0f, 2.0f };
+	v *= 3.0f;
+	v /= 2.0f;
+	return v == Vector3{ 3.0f, 3.0f, 3.0f };
+}());
+static_assert(Vector3A(1.0f, 2.0f, 3.0f).ToVector3() == Vector3{ 1.0f, 2.0f, 3.0f });
+
+// 比較用の素朴な行列の積
+Matrix4x4 MultiplyNaive(const Matrix4x4& m1, const Matrix4x4& m2) {
+	Matrix4x4 result = {};
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			for (int k = 0; k < 4; k++) {
+				result.m[row][column] += m1.m[row][k] * m2.m[k][column];
+			}
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+int main() {
+	mt19937 randomEngine(12345);
+	uniform_real_distribution<float> unitDistribution(-1.0f, 1.0f);
+	uniform_real_distribution<float> angleDistribution(-numbers::pi_v<float>, numbers::pi_v<float>);
+	uniform_real_distribution<float> scaleDistribution(0.5f, 2.0f);
+	uniform_real_distribution<float> positionDistribution(-50.0f, 50.0f);
+
+	// 入力データ
+	vector<Matrix4x4> matrices(kNumInputs);
+	vector<Transform> transforms(kNumInputs);
+	vector<Matrix4x4> affineMatrices(kNumInputs);
+	vector<Vector3> vectors(kNumInputs);
+	Matrix matrix;
+	for (size_t i = 0; i < kNumInputs; i++) {
+		for (auto& row : matrices[i].m) {
+			for (float& element : row) {
+				element = unitDistribution(randomEngine);
+			}
+		}
+		transforms[i].scale = { scaleDistribution(randomEngine), scaleDistribution(randomEngine), scaleDistribution(randomEngine) };
+		transforms[i].rotate = { angleDistribution(randomEngine), angleDistribution(randomEngine), angleDistribution(randomEngine) };
+		transforms[i].translate = { positionDistribution(randomEngine), positionDistribution(randomEngine), positionDistribution(randomEngine) };
+		affineMatrices[i] = matrix.MakeAffineMatrix(transforms[i].scale, transforms[i].rotate, transforms[i].translate);
+		vectors[i] = { unitDistribution(randomEngine), unitDistribution(randomEngine), unitDistribution(randomEngine) };
+	}
+	vector<Matrix4x4> results(kNumInputs);
+
+	// 結果を読んで最適化で消されないようにする
+	auto consume = [&results]() {
+		float sum = 0.0f;
+		for (const Matrix4x4& m : results) {
+			sum += m.m[0][0] + m.m[3][2];
+		}
+		gSink = gSink + sum;
+	};
+
+	printf("== Matrix ==\n");
+	{
+		double ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			ulp = max(ulp, UlpErrorOfProduct(matrix.Multiply(matrices[i], matrices[(i + 1) & (kNumInputs - 1)]), ToDouble(matrices[i]), ToDouble(matrices[(i + 1) & (kNumInputs - 1)])));
+		}
+		double time = Measure([&](size_t i) { results[i] = matrix.Multiply(matrices[i], matrices[(i + 1) & (kNumInputs - 1)]); });
+		consume();
+		Report("Multiply", time, ulp, 4.0);
+		time = Measure([&](size_t i) { results[i] = MultiplyNaive(matrices[i], matrices[(i + 1) & (kNumInputs - 1)]); });
+		consume();
+		Report("Multiply (naive scalar)", time);
+		time = Measure([&](size_t) { matrix.MultiplyBatch(matrices.data(), matrices[0], results.data(), kNumInputs); }, kNumIterations / kNumInputs) / double(kNumInputs);
+		consume();
+		Report("MultiplyBatch (per matrix)", time);
+	}
+	{
+		double ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			ulp = max(ulp, UlpError(matrix.Inverse(affineMatrices[i]), InverseD(ToDouble(affineMatrices[i]))));
+		}
+		double time = Measure([&](size_t i) { results[i] = matrix.Inverse(affineMatrices[i]); });
+		consume();
+		Report("Inverse", time, ulp, 32.0);
+
+		ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			ulp = max(ulp, UlpError(matrix.InverseAffine(affineMatrices[i]), InverseD(ToDouble(affineMatrices[i]))));
+		}
+		time = Measure([&](size_t i) { results[i] = matrix.InverseAffine(affineMatrices[i]); });
+		consume();
+		Report("InverseAffine", time, ulp, 32.0);
+
+		// 回転と平行移動だけの行列で、InverseRigidとInverseの結果を比べる
+		vector<Matrix4x4> rigidMatrices(kNumInputs);
+		for (size_t i = 0; i < kNumInputs; i++) {
+			rigidMatrices[i] = matrix.MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, transforms[i].rotate, transforms[i].translate);
+		}
+		ulp = 0.0;
+		for (const Matrix4x4& m : rigidMatrices) {
+			ulp = max(ulp, UlpError(matrix.InverseRigid(m), ToDouble(matrix.Inverse(m))));
+		}
+		time = Measure([&](size_t i) { results[i] = matrix.InverseRigid(rigidMatrices[i]); });
+		consume();
+		Report("InverseRigid (vs Inverse)", time, ulp, 32.0);
+
+		// カメラのTransformから作ったビュー行列と、カメラ行列のInverseを比べる
+		ulp = 0.0;
+		for (const Transform& t : transforms) {
+			ulp = max(ulp, UlpError(matrix.MakeViewMatrix(t), ToDouble(matrix.Inverse(matrix.MakeAffineMatrix(t.scale, t.rotate, t.translate)))));
+		}
+		time = Measure([&](size_t i) { results[i] = matrix.MakeViewMatrix(transforms[i]); });
+		consume();
+		Report("MakeViewMatrix (vs Inverse)", time, ulp, 32.0);
+		time = Measure([&](size_t i) { results[i] = matrix.Inverse(matrix.MakeAffineMatrix(transforms[i].scale, transforms[i].rotate, transforms[i].translate)); });
+		consume();
+		Report("Inverse(MakeAffineMatrix)", time);
+	}
+	{
+		double ulp = 0.0;
+		for (const Transform& t : transforms) {
+			ulp = max(ulp, UlpError(matrix.MakeAffineMatrix(t.scale, t.rotate, t.translate), MakeAffineMatrixD(t.scale, t.rotate, t.translate)));
+		}
+		double time = Measure([&](size_t i) { results[i] = matrix.MakeAffineMatrix(transforms[i].scale, transforms[i].rotate, transforms[i].translate); });
+		consume();
+		Report("MakeAffineMatrix", time, ulp, 16.0);
+
+		ulp = 0.0;
+		for (const Transform& t : transforms) {
+			ulp = max(ulp, UlpError(matrix.MakeAffineMatrixReference(t.scale, t.rotate, t.translate), MakeAffineMatrixD(t.scale, t.rotate, t.translate)));
+		}
+		time = Measure([&](size_t i) { results[i] = matrix.MakeAffineMatrixReference(transforms[i].scale, transforms[i].rotate, transforms[i].translate); });
+		consume();
+		Report("MakeAffineMatrixReference", time, ulp, 16.0);
+	}
+	{
+		double ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const float fovY = 0.2f + 0.001f * float(i);
+			ulp = max(ulp, UlpError(matrix.MakePerspectiveFovMatrix(fovY, 16.0f / 9.0f, 0.1f, 100.0f), MakePerspectiveFovMatrixD(fovY, 16.0f / 9.0f, 0.1f, 100.0f)));
+		}
+		double time = Measure([&](size_t i) { results[i] = matrix.MakePerspectiveFovMatrix(0.2f + 0.001f * float(i), 16.0f / 9.0f, 0.1f, 100.0f); });
+		consume();
+		Report("MakePerspectiveFovMatrix", time, ulp, 4.0);
+
+		ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const float right = 640.0f + float(i);
+			ulp = max(ulp, UlpError(matrix.MakeOrthographicMatrix(0.0f, 0.0f, right, 720.0f, 0.0f, 100.0f), MakeOrthographicMatrixD(0.0f, 0.0f, right, 720.0f, 0.0f, 100.0f)));
+		}
+		time = Measure([&](size_t i) { results[i] = matrix.MakeOrthographicMatrix(0.0f, 0.0f, 640.0f + float(i), 720.0f, 0.0f, 100.0f); });
+		consume();
+		Report("MakeOrthographicMatrix", time, ulp, 4.0);
+	}
+
+	printf("== Transform ==\n");
+	{
+		// 軸ごとの回転行列を掛け合わせる場合とクォータニオンを経由する場合
+		double time = Measure([&](size_t i) {
+			const Vector3& r = transforms[i].rotate;
+			results[i] = matrix.Multiply(matrix.MakeRotateXMatrix(r.x), matrix.Multiply(matrix.MakeRotateYMatrix(r.y), matrix.MakeRotateZMatrix(r.z)));
+		});
+		consume();
+		Report("MakeRotateX/Y/Z chain", time);
+
+		double ulp = 0.0;
+		for (const Transform& t : transforms) {
+			ulp = max(ulp, UlpError(MakeRotateMatrix(MakeRotateEulerQuaternion(t.rotate)), MakeAffineMatrixD({ 1.0f, 1.0f, 1.0f }, t.rotate, {})));
+		}
+		time = Measure([&](size_t i) { results[i] = MakeRotateMatrix(MakeRotateEulerQuaternion(transforms[i].rotate)); });
+		consume();
+		Report("Euler -> Quaternion -> Matrix", time, ulp, 16.0);
+
+		time = Measure([&](size_t i) {
+			const Quaternion q0 = MakeRotateEulerQuaternion(transforms[i].rotate);
+			const Quaternion q1 = MakeRotateEulerQuaternion(transforms[(i + 1) & (kNumInputs - 1)].rotate);
+			results[i] = MakeRotateMatrix(Slerp(q0, q1, 0.3f));
+		});
+		consume();
+		Report("Slerp (with 2 Euler conversions)", time);
+	}
+	{
+		// フラグで特殊化した作り方。Y軸回転と一様スケールだけの入力を使う
+		vector<Transform> yawTransforms(transforms);
+		for (Transform& t : yawTransforms) {
+			t.scale = { t.scale.x, t.scale.x, t.scale.x };
+			t.rotate = { 0.0f, t.rotate.y, 0.0f };
+		}
+		const uint32_t kFlags = kTransformFlagUniformScale | kTransformFlagYaw;
+		double ulp = 0.0;
+		for (const Transform& t : yawTransforms) {
+			ulp = max(ulp, UlpError(MakeTransformMatrix<kFlags>(t), MakeAffineMatrixD(t.scale, t.rotate, t.translate)));
+		}
+		double time = Measure([&](size_t i) { results[i] = MakeTransformMatrix<kFlags>(yawTransforms[i]); });
+		consume();
+		Report("MakeTransformMatrix<UniformScale|Yaw>", time, ulp, 16.0);
+		time = Measure([&](size_t i) { results[i] = MakeTransformMatrix(yawTransforms[i]); });
+		consume();
+		Report("MakeTransformMatrix (classify)", time);
+		time = Measure([&](size_t i) { results[i] = matrix.MakeAffineMatrix(yawTransforms[i].scale, yawTransforms[i].rotate, yawTransforms[i].translate); });
+		consume();
+		Report("MakeAffineMatrix (same input)", time);
+	}
+	{
+		// パーティクルの場を想定し、9割が平行移動のみ、残りが任意の変換の入力を混ぜて使う
+		mt19937 fieldEngine(54321);
+		bernoulli_distribution translationOnlyDistribution(0.9);
+		vector<Transform> fieldTransforms(transforms);
+		vector<uint32_t> fieldFlags(kNumInputs);
+		size_t numTranslationOnly = 0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			if (translationOnlyDistribution(fieldEngine)) {
+				fieldTransforms[i].scale = { 1.0f, 1.0f, 1.0f };
+				fieldTransforms[i].rotate = { 0.0f, 0.0f, 0.0f };
+				numTranslationOnly++;
+			}
+			fieldFlags[i] = ClassifyTransform(fieldTransforms[i]);
+		}
+		double ulp = 0.0;
+		for (const Transform& t : fieldTransforms) {
+			ulp = max(ulp, UlpError(MakeTransformMatrix(t), MakeAffineMatrixD(t.scale, t.rotate, t.translate)));
+		}
+		printf("Field: %zu / %zu translation only\n", numTranslationOnly, kNumInputs);
+		double time = Measure([&](size_t i) { results[i] = MakeTransformMatrix(fieldTransforms[i]); });
+		consume();
+		Report("Field: MakeTransformMatrix (classify)", time, ulp, 16.0);
+		time = Measure([&](size_t i) { results[i] = MakeTransformMatrix(fieldTransforms[i], fieldFlags[i]); });
+		consume();
+		Report("Field: MakeTransformMatrix (flags)", time);
+		time = Measure([&](size_t i) { results[i] = matrix.MakeAffineMatrix(fieldTransforms[i].scale, fieldTransforms[i].rotate, fieldTransforms[i].translate); });
+		consume();
+		Report("Field: MakeAffineMatrix", time);
+	}
+	{
+		// 全要素のWorldとWVPをまとめて作る
+		TransformArray transformArray;
+		transformArray.Resize(kNumInputs);
+		for (size_t i = 0; i < kNumInputs; i++) {
+			transformArray.Set(i, transforms[i]);
+		}
+		const Matrix4x4 viewProjection = matrix.Multiply(matrix.Inverse(affineMatrices[0]), matrix.MakePerspectiveFovMatrix(0.45f, 16.0f / 9.0f, 0.1f, 100.0f));
+		vector<TransformationMatrix> output(kNumInputs);
+		transformArray.BuildWorldMatrices(output, viewProjection);
+		double ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Matrix4x4d world = MakeAffineMatrixD(transforms[i].scale, transforms[i].rotate, transforms[i].translate);
+			ulp = max({ ulp, UlpError(output[i].World, world), UlpErrorOfProduct(output[i].WVP, world, ToDouble(viewProjection)) });
+		}
+		double time = Measure([&](size_t) { transformArray.BuildWorldMatrices(output, viewProjection); }, kNumIterations / kNumInputs) / double(kNumInputs);
+		gSink = gSink + output[0].WVP.m[0][0];
+		Report("TransformArray::BuildWorldMatrices", time, ulp, 64.0);
+
+		// 見える要素だけを詰めて書き込む。4つ続けて見えない所と、ところどころ見えない所を混ぜる
+		vector<uint8_t> visible(kNumInputs);
+		for (size_t i = 0; i < kNumInputs; i++) {
+			visible[i] = (i / 8) % 2 == 0 && i % 3 != 0 ? 1 : 0;
+		}
+		vector<TransformationMatrix> visibleOutput(kNumInputs);
+		const size_t numVisible = transformArray.BuildWorldMatrices(visibleOutput, viewProjection, visible);
+		size_t expected = 0;
+		bool visiblePassed = true;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			if (visible[i] != 0) {
+				visiblePassed = visiblePassed && expected < numVisible && memcmp(&visibleOutput[expected], &output[i], sizeof(TransformationMatrix)) == 0;
+				expected++;
+			}
+		}
+		visiblePassed = visiblePassed && numVisible == expected;
+		time = Measure([&](size_t) { transformArray.BuildWorldMatrices(visibleOutput, viewProjection, visible); }, kNumIterations / kNumInputs) / double(kNumInputs);
+		gSink = gSink + visibleOutput[0].WVP.m[0][0];
+		Report("TransformArray::BuildWorldMatrices (visible)", time);
+		Check("TransformArray visible (same as all)", visiblePassed);
+	}
+
+	printf("== Vector operators ==\n");
+	{
+		// 実行時の結果を要素ごとの計算と比べる。同じ計算なので一致するはず
+		bool vector2Passed = true, vector4Passed = true, lerpPassed = true;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Vector3& a3 = vectors[i];
+			const Vector3& b3 = vectors[(i + 1) & (kNumInputs - 1)];
+			const Vector2 a2 = { a3.x, a3.y }, b2 = { b3.x, b3.y };
+			const Vector4 a4 = { a3.x, a3.y, a3.z, b3.x }, b4 = { b3.x, b3.y, b3.z, a3.z };
+			const float s = b3.z;
+			vector2Passed = vector2Passed && a2 + b2 == Vector2{ a2.x + b2.x, a2.y + b2.y } && a2 - b2 == Vector2{ a2.x - b2.x, a2.y - b2.y } &&
+				a2 * b2 == Vector2{ a2.x * b2.x, a2.y * b2.y } && a2 * s == Vector2{ a2.x * s, a2.y * s } && s * a2 == a2 * s &&
+				a2 / s == Vector2{ a2.x / s, a2.y / s } && -a2 == Vector2{ -a2.x, -a2.y } &&
+				Dot(a2, b2) == a2.x * b2.x + a2.y * b2.y && Cross(a2, b2) == a2.x * b2.y - a2.y * b2.x;
+			vector4Passed = vector4Passed && a4 + b4 == Vector4{ a4.x + b4.x, a4.y + b4.y, a4.z + b4.z, a4.w + b4.w } &&
+				a4 - b4 == Vector4{ a4.x - b4.x, a4.y - b4.y, a4.z - b4.z, a4.w - b4.w } &&
+				a4 * b4 == Vector4{ a4.x * b4.x, a4.y * b4.y, a4.z * b4.z, a4.w * b4.w } &&
+				a4 * s == Vector4{ a4.x * s, a4.y * s, a4.z * s, a4.w * s } && s * a4 == a4 * s &&
+				a4 / s == Vector4{ a4.x / s, a4.y / s, a4.z / s, a4.w / s } && -a4 == Vector4{ -a4.x, -a4.y, -a4.z, -a4.w } &&
+				Dot(a4, b4) == a4.x * b4.x + a4.y * b4.y + a4.z * b4.z + a4.w * b4.w;
+			// 端点ではそれぞれの値、途中は各要素の補間と一致する
+			const float t = (s + 1.0f) * 0.5f;
+			lerpPassed = lerpPassed && Lerp(a2, b2, 0.0f) == a2 && Lerp(a3, b3, 0.0f) == a3 && Lerp(a4, b4, 0.0f) == a4 &&
+				Lerp(a2, b2, t) == Vector2{ a2.x + (b2.x - a2.x) * t, a2.y + (b2.y - a2.y) * t } &&
+				Lerp(a3, b3, t) == Vector3{ a3.x + (b3.x - a3.x) * t, a3.y + (b3.y - a3.y) * t, a3.z + (b3.z - a3.z) * t } &&
+				Lerp(a4, b4, t) == Vector4{ a4.x + (b4.x - a4.x) * t, a4.y + (b4.y - a4.y) * t, a4.z + (b4.z - a4.z) * t, a4.w + (b4.w - a4.w) * t };
+		}
+		Check("Vector2 operators", vector2Passed);
+		Check("Vector4 operators", vector4Passed);
+		Check("Lerp (Vector2/3/4)", lerpPassed);
+
+		// Vector3AはVector3と比べる。割り算は逆数を掛けるので1ULPずれることがある
+		double addUlp = 0.0, divideUlp = 0.0, dotUlp = 0.0;
+		bool wPassed = true;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Vector3& a = vectors[i];
+			const Vector3& b = vectors[(i + 1) & (kNumInputs - 1)];
+			const float s = b.z != 0.0f ? b.z : 1.0f;
+			const Vector3A sum = Vector3A(a) + Vector3A(b);
+			const Vector3A difference = Vector3A(a) - Vector3A(b);
+			const Vector3A product = Vector3A(a) * Vector3A(b);
+			const Vector3A quotient = Vector3A(a) / s;
+			const Vector3 referenceSum = a + b, referenceDifference = a - b, referenceProduct = a * b;
+			addUlp = max({ addUlp, UlpError(sum.ToVector3(), referenceSum.x, referenceSum.y, referenceSum.z),
+				UlpError(difference.ToVector3(), referenceDifference.x, referenceDifference.y, referenceDifference.z),
+				UlpError(product.ToVector3(), referenceProduct.x, referenceProduct.y, referenceProduct.z) });
+			divideUlp = max(divideUlp, UlpError(quotient.ToVector3(), double(a.x) / s, double(a.y) / s, double(a.z) / s));
+			const double reference = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+			dotUlp = max(dotUlp, UlpError(Dot(Vector3A(a), Vector3A(b)), reference, abs(double(a.x) * b.x) + abs(double(a.y) * b.y) + abs(double(a.z) * b.z)));
+			// wは0のまま
+			wPassed = wPassed && sum.w == 0.0f && difference.w == 0.0f && quotient.w == 0.0f && Cross(Vector3A(a), Vector3A(b)).w == 0.0f;
+		}
+		ReportAccuracy("Vector3A + - * (vs Vector3)", addUlp, 0.0);
+		ReportAccuracy("Vector3A / (vs double)", divideUlp, 2.0);
+		ReportAccuracy("Dot (Vector3A)", dotUlp, 4.0);
+		Check("Vector3A w stays 0", wPassed);
+	}
+
+	printf("== Vector ==\n");
+	{
+		vector<Vector3> vectorResults(kNumInputs);
+		auto consumeVectors = [&vectorResults]() {
+			float sum = 0.0f;
+			for (const Vector3& v : vectorResults) {
+				sum += v.x;
+			}
+			gSink = gSink + sum;
+		};
+
+		double ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Vector3& a = vectors[i];
+			const Vector3& b = vectors[(i + 1) & (kNumInputs - 1)];
+			const double reference = double(a.x) * b.x + double(a.y) * b.y + double(a.z) * b.z;
+			ulp = max(ulp, UlpError(Dot(a, b), reference, abs(double(a.x) * b.x) + abs(double(a.y) * b.y) + abs(double(a.z) * b.z)));
+		}
+		double time = Measure([&](size_t i) { vectorResults[i].x = Dot(vectors[i], vectors[(i + 1) & (kNumInputs - 1)]); });
+		consumeVectors();
+		Report("Dot", time, ulp, 4.0);
+
+		ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Vector3& a = vectors[i];
+			const Vector3& b = vectors[(i + 1) & (kNumInputs - 1)];
+			ulp = max(ulp, UlpErrorOfCross(Cross(a, b), a, b));
+		}
+		time = Measure([&](size_t i) { vectorResults[i] = Cross(vectors[i], vectors[(i + 1) & (kNumInputs - 1)]); });
+		consumeVectors();
+		Report("Cross", time, ulp, 4.0);
+
+		ulp = 0.0;
+		for (const Vector3& v : vectors) {
+			const double length = sqrt(double(v.x) * v.x + double(v.y) * v.y + double(v.z) * v.z);
+			ulp = max(ulp, UlpError(Normalize(v), v.x / length, v.y / length, v.z / length));
+		}
+		time = Measure([&](size_t i) { vectorResults[i] = Normalize(vectors[i]); });
+		consumeVectors();
+		Report("Normalize", time, ulp, 4.0);
+
+		ulp = 0.0;
+		for (size_t i = 0; i < kNumInputs; i++) {
+			const Vector3& a = vectors[i];
+			const Vector3& b = vectors[(i + 1) & (kNumInputs - 1)];
+			ulp = max(ulp, UlpErrorOfCross(Cross(Vector3A(a), Vector3A(b)).ToVector3(), a, b));
+		}
+		time = Measure([&](size_t i) { vectorResults[i] = Cross(Vector3A(vectors[i]), Vector3A(vectors[(i + 1) & (kNumInputs - 1)])).ToVector3(); });
+		consumeVectors();
+		Report("Cross (Vector3A)", time, ulp, 4.0);
+
+		ulp = 0.0;
+		for (const Vector3& v : vectors) {
+			const double length = sqrt(double(v.x) * v.x + double(v.y) * v.y + double(v.z) * v.z);
+			ulp = max(ulp, UlpError(Normalize(Vector3A(v)).ToVector3(), v.x / length, v.y / length, v.z / length));
+		}
+		time = Measure([&](size_t i) { vectorResults[i] = Normalize(Vector3A(vectors[i])).ToVector3(); });
+		consumeVectors();
+		Report("Normalize (Vector3A)", time, ulp, 4.0);
+
+		// 配列をVector3Aのまま持ち、変換を挟まずに続けて計算する場合
+		vector<Vector3A> alignedVectors(kNumInputs), alignedResults(kNumInputs);
+		for (size_t i = 0; i < kNumInputs; i++) {
+			alignedVectors[i] = Vector3A(vectors[i]);
+		}
+		time = Measure([&](size_t i) { vectorResults[i] = Normalize(Cross(vectors[i], vectors[(i + 1) & (kNumInputs - 1)])); });
+		consumeVectors();
+		Report("Normalize(Cross) (Vector3 arrays)", time);
+		time = Measure([&](size_t i) { alignedResults[i] = Normalize(Cross(alignedVectors[i], alignedVectors[(i + 1) & (kNumInputs - 1)])); });
+		gSink = gSink + alignedResults[0].x;
+		Report("Normalize(Cross) (Vector3A arrays)", time);
+	}
+
+	printf("== Culling ==\n");
+	{
+		// 100万個の球の視錐台カリング
+		const size_t kNumSpheres = 1000000;
+		vector<float> centerX(kNumSpheres), centerY(kNumSpheres), centerZ(kNumSpheres), radii(kNumSpheres);
+		vector<uint8_t> visible(kNumSpheres);
+		uniform_real_distribution<float> radiusDistribution(0.1f, 2.0f);
+		for (size_t i = 0; i < kNumSpheres; i++) {
+			centerX[i] = positionDistribution(randomEngine);
+			centerY[i] = positionDistribution(randomEngine);
+			centerZ[i] = positionDistribution(randomEngine);
+			radii[i] = radiusDistribution(randomEngine);
+		}
+		const Matrix4x4 viewProjection = matrix.MakePerspectiveFovMatrix(0.45f, 16.0f / 9.0f, 0.1f, 100.0f);
+		const Frustum frustum = MakeFrustum(viewProjection);
+
+		double time = Measure([&](size_t) { CullSpheres(frustum, centerX, centerY, centerZ, radii, visible); }, 1) / double(kNumSpheres);
+		size_t numMismatches = 0;
+		for (size_t i = 0; i < kNumSpheres; i++) {
+			numMismatches += (visible[i] != 0) != IsVisible(frustum, Sphere{ { centerX[i], centerY[i], centerZ[i] }, radii[i] }) ? 1 : 0;
+		}
+		// 判定が食い違った個数を誤差の欄に出す
+		Report("CullSpheres (per sphere, mismatches)", time, double(numMismatches), 0.0);
+		time = Measure([&](size_t) {
+			for (size_t i = 0; i < kNumSpheres; i++) {
+				visible[i] = IsVisible(frustum, Sphere{ { centerX[i], centerY[i], centerZ[i] }, radii[i] }) ? 1 : 0;
+			}
+		}, 1) / double(kNumSpheres);
+		Report("IsVisible loop (per sphere)", time);
+	}
+
+	printf("%s (%d failed)\n", gNumFailed == 0 ? "PASSED" : "FAILED", gNumFailed);
+	return gNumFailed == 0 ? 0 : 1;
+}
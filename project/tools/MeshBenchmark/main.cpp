@@ -0,0 +1,1133 @@
+// メッシュ読み込みのベンチマーク
+// 三角形を並べたobjファイルを生成し、読み込み速度(MB/s)を比較する
+// Windows以外でも以下のようにビルドできる
+//   g++ -std=c++20 -O2 -I../.. -I../../engine/math main.cpp ../../engine/3d/MeshBounds.cpp ../../engine/3d/Meshlet.cpp ../../engine/3d/MeshOptimizer.cpp ../../engine/3d/MeshSimplifier.cpp ../../engine/3d/PackedVertex.cpp ../../engine/3d/TangentSpace.cpp ../../engine/base/*.cpp ../../engine/io/*.cpp ../../engine/math/Geometry.cpp
+// 使い方: MeshBenchmark [三角形の数（既定は1000万）]
+#include "engine/3d/MeshBounds.h"
+#include "engine/3d/Meshlet.h"
+#include "engine/3d/MeshOptimizer.h"
+#include "engine/3d/MeshSimplifier.h"
+#include "engine/3d/PackedVertex.h"
+#include "engine/3d/TangentSpace.h"
+#include "engine/base/AssetRegistry.h"
+#include "engine/io/MeshFile.h"
+#include "engine/io/ObjLoader.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 比較用。istringstreamで1行ずつ読む以前の実装
+ModelData LoadObjFileLegacy(const string& directoryPath, const string& filename) {
+	ModelData modelData;
+	vector<Vector4> positions;
+	vector<Vector3> normals;
+	vector<Vector2> texcoords;
+	string line;
+
+	ifstream file(directoryPath + "/" + filename);
+	assert(file.is_open());
+
+	while (getline(file, line)) {
+		string identifier;
+		istringstream s(line);
+		s >> identifier;
+
+		if (identifier == "v") {
+			Vector4 position;
+			s >> position.x >> position.y >> position.z;
+			position.x *= -1.0f;
+			position.w = 1.0f;
+			positions.push_back(position);
+		} else if (identifier == "vt") {
+			Vector2 texcoord;
+			s >> texcoord.x >> texcoord.y;
+			texcoord.y = 1.0f - texcoord.y;
+			texcoords.push_back(texcoord);
+		} else if (identifier == "vn") {
+			Vector3 normal;
+			s >> normal.x >> normal.y >> normal.z;
+			normal.x *= -1.0f;
+			normals.push_back(normal);
+		} else if (identifier == "f") {
+			VertexData triangle[3];
+			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex) {
+				string vertexDefinition;
+				s >> vertexDefinition;
+				istringstream v(vertexDefinition);
+				uint32_t elementIndices[3];
+				for (uint32_t element = 0; element < 3; ++element) {
+					string index;
+					getline(v, index, '/');
+					elementIndices[element] = stoi(index);
+				}
+				Vector4 position = positions[elementIndices[0] - 1];
+				Vector2 texcoord = texcoords[elementIndices[1] - 1];
+				Vector3 normal = normals[elementIndices[2] - 1];
+				triangle[faceVertex] = { position, texcoord, normal };
+			}
+			modelData.verticles.push_back(triangle[2]);
+			modelData.verticles.push_back(triangle[1]);
+			modelData.verticles.push_back(triangle[0]);
+		}
+	}
+
+	return modelData;
+}
+
+// 格子状に並べた三角形のobjを生成する
+void WriteGridObj(const filesystem::path& path, size_t numTriangles) {
+	const size_t numQuads = (numTriangles + 1) / 2;
+	const size_t width = max<size_t>(1, size_t(sqrt(double(numQuads))));
+	const size_t height = (numQuads + width - 1) / width;
+
+	ofstream file(path, ios::binary);
+	assert(file.is_open());
+	string buffer;
+	char line[128];
+	auto flush = [&]() {
+		file.write(buffer.data(), streamsize(buffer.size()));
+		buffer.clear();
+	};
+
+	for (size_t y = 0; y <= height; y++) {
+		for (size_t x = 0; x <= width; x++) {
+			const float u = float(x) / float(width);
+			const float v = float(y) / float(height);
+			buffer.append(line, size_t(snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.25f * sin(u * 20.0f) * cos(v * 20.0f), u, v)));
+		}
+		if (buffer.size() > (1 << 20)) {
+			flush();
+		}
+	}
+	buffer += "vn 0.000000 0.000000 1.000000\n";
+
+	size_t written = 0;
+	for (size_t y = 0; y < height && written < numTriangles; y++) {
+		for (size_t x = 0; x < width && written < numTriangles; x++) {
+			const size_t i0 = y * (width + 1) + x + 1;
+			const size_t i1 = i0 + 1;
+			const size_t i2 = i0 + width + 1;
+			const size_t i3 = i2 + 1;
+			buffer.append(line, size_t(snprintf(line, sizeof(line), "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", i0, i0, i1, i1, i3, i3)));
+			if (++written < numTriangles) {
+				buffer.append(line, size_t(snprintf(line, sizeof(line), "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", i0, i0, i3, i3, i2, i2)));
+				++written;
+			}
+		}
+		if (buffer.size() > (1 << 20)) {
+			flush();
+		}
+	}
+	flush();
+}
+
+// 頂点データのハッシュ（FNV-1a）。読み込み結果が一致するかの確認に使う
+uint64_t Hash(const ModelData& modelData) {
+	uint64_t hash = 14695981039346656037ull;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(modelData.verticles.data());
+	for (size_t i = 0; i < modelData.verticles.size() * sizeof(VertexData); i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+// 三角形の集合のハッシュ。三角形ごとのハッシュの和なので、三角形の順番によらない
+uint64_t HashTriangles(const ModelData& modelData) {
+	uint64_t sum = 0;
+	for (size_t i = 0; i + 2 < modelData.indices.size(); i += 3) {
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t k = 0; k < 3; k++) {
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&modelData.verticles[modelData.indices[i + k]]);
+			for (size_t j = 0; j < sizeof(VertexData); j++) {
+				hash = (hash ^ bytes[j]) * 1099511628211ull;
+			}
+		}
+		sum += hash;
+	}
+	return sum;
+}
+
+// 読み込みにかかった時間と結果のハッシュ
+struct Result {
+	double seconds;
+	size_t numVertices;
+	uint64_t hash;
+};
+
+template <typename Func>
+Result Measure(Func&& load) {
+	auto start = chrono::steady_clock::now();
+	ModelData modelData = load();
+	auto end = chrono::steady_clock::now();
+	return { chrono::duration<double>(end - start).count(), modelData.verticles.size(), Hash(modelData) };
+}
+
+void Report(const char* name, const Result& result, double megabytes) {
+	printf("%-24s %8.3f s %10.1f MB/s %12zu vertices  hash %016llx\n", name, result.seconds, megabytes / result.seconds, result.numVertices, static_cast<unsigned long long>(result.hash));
+}
+
+// 三角形リストとしての頂点列。indicesがあれば展開する
+vector<VertexData> ExpandVertices(const ModelData& modelData) {
+	if (modelData.indices.empty()) {
+		return modelData.verticles;
+	}
+	vector<VertexData> expanded;
+	expanded.reserve(modelData.indices.size());
+	for (uint32_t index : modelData.indices) {
+		expanded.push_back(modelData.verticles[index]);
+	}
+	return expanded;
+}
+
+// 一部の面にだけ法線があるobjで、ファイルにある法線が作った法線で上書きされないかを確認する
+bool CheckPartialNormals(bool indexed) {
+	// 先頭の面だけ、面の向きと違う法線が書いてある
+	const char* text =
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 1\n"
+		"vn 0.6 0 0.8\n"
+		"f 1//1 2//1 3//1\n"
+		"f 1 3 4\n"
+		"f 1 5 2\n";
+	ObjLoadOptions options;
+	options.indexed = indexed;
+	const vector<VertexData> vertices = ExpandVertices(ParseObj(text, "", options));
+	if (vertices.size() != 9) {
+		return false;
+	}
+	for (size_t i = 0; i < vertices.size(); i++) {
+		const Vector3& normal = vertices[i].normal;
+		if (i < 3) {
+			// xは左手系にするため反転される
+			if (normal.x != -0.6f || normal.y != 0.0f || normal.z != 0.8f) {
+				return false;
+			}
+		} else if (abs(Length(normal) - 1.0f) > 1e-4f) {
+			return false;
+		} else if (vertices[i].position.y == 1.0f && abs(normal.z) < 0.999f) {
+			// (0,1,0)はz=0の面にしか使われていないので、その面の法線になる
+			return false;
+		}
+	}
+	return true;
+}
+
+// 4通りの面の書き方（v, v/vt, v//vn, v/vt/vn）で、省略したUVと法線以外が書いた通りになるかを確認する
+bool CheckFaceFormats() {
+	const string elements =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 0 1\n"
+		"vn 0 0 1\n";
+	const char* faces[] = { "f 1 2 3\n", "f 1/1 2/2 3/3\n", "f 1//1 2//1 3//1\n", "f 1/1/1 2/2/1 3/3/1\n" };
+	const Vector2 texcoords[3] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f } };
+	for (int format = 0; format < 4; format++) {
+		const bool hasTexcoord = (format & 1) != 0;
+		const bool hasNormal = (format & 2) != 0;
+		const ModelData modelData = ParseObj(elements + faces[format], "");
+		if (modelData.verticles.size() != 3) {
+			return false;
+		}
+		for (size_t i = 0; i < 3; i++) {
+			// 周り順を逆にするので、ファイルの3番目の頂点から並ぶ。xとvは反転される
+			const VertexData& vertex = modelData.verticles[i];
+			const size_t source = 2 - i;
+			const Vector2 texcoord = hasTexcoord ? Vector2{ texcoords[source].x, 1.0f - texcoords[source].y } : Vector2{ 0.0f, 0.0f };
+			if (vertex.position.x != (source == 1 ? -1.0f : 0.0f) || vertex.position.y != (source == 2 ? 1.0f : 0.0f) || vertex.position.z != 0.0f ||
+				vertex.texcoord.x != texcoord.x || vertex.texcoord.y != texcoord.y) {
+				return false;
+			}
+			// 法線がなければ面の向きから作るので、書いたものと同じ向きになる
+			if (hasNormal ? (vertex.normal.x != 0.0f || vertex.normal.y != 0.0f || vertex.normal.z != 1.0f) : abs(vertex.normal.z - 1.0f) > 1e-6f) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// 凹んだ多角形を分割した三角形が、すべて同じ向きで元の面積になるかを確認する
+bool CheckConcavePolygon() {
+	// 凹んだ角(1,1)の隣から始まるL字形なので、扇形に分けると裏返った三角形ができる。後ろの四角形は凸
+	const char* text =
+		"v 2 1 0\nv 1 1 0\nv 1 2 0\nv 0 2 0\nv 0 0 0\nv 2 0 0\n"
+		"v 3 0 0\nv 4 0 0\nv 4 1 0\nv 3 1 0\n"
+		"f 1 2 3 4 5 6\n"
+		"f 7 8 9 10\n";
+	const ModelData modelData = ParseObj(text, "");
+	if (modelData.verticles.size() != (4 + 2) * 3) {
+		return false;
+	}
+	float area = 0.0f;
+	for (size_t i = 0; i < modelData.verticles.size(); i += 3) {
+		const Vector4& p0 = modelData.verticles[i + 0].position;
+		const Vector4& p1 = modelData.verticles[i + 1].position;
+		const Vector4& p2 = modelData.verticles[i + 2].position;
+		// xy平面上の三角形なので、外積のzが符号付きの面積の2倍
+		const float doubleArea = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+		if (doubleArea <= 0.0f) {
+			return false;
+		}
+		area += doubleArea * 0.5f;
+	}
+	return abs(area - 4.0f) < 1e-5f;
+}
+
+// チャンクを分けるのに十分な長さのコメント行
+string MakeObjPadding(size_t bytes) {
+	const string line = "# padding to split the text into chunks\n";
+	string padding;
+	padding.reserve(bytes + line.size());
+	while (padding.size() < bytes) {
+		padding += line;
+	}
+	return padding;
+}
+
+// 負のIndexがチャンクの境界をまたいで前のチャンクの要素を指しても、正のIndexで書いたものと同じ結果になるかを確認する
+bool CheckRelativeIndices() {
+	// 区切りはテキストの中央なので、前後の要素と面はコメントを挟んで別のチャンクに入る
+	const string head =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 0 1\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/2/1 3/3/1\n";
+	const string padding = MakeObjPadding(3 << 20);
+	const string relative = head + padding +
+		"f -3/-3/-1 -2/-2/-1 -1/-1/-1\n"
+		"v 0 0 1\nv 1 0 1\nv 0 1 1\n"
+		"vn 0 1 0\n"
+		"f -3//-1 -2//-1 -1//-1\n"
+		"f -6/-3/-2 -5/-2/-2 -1/-1/-1\n";
+	const string absolute = head + padding +
+		"f 1/1/1 2/2/1 3/3/1\n"
+		"v 0 0 1\nv 1 0 1\nv 0 1 1\n"
+		"vn 0 1 0\n"
+		"f 4//2 5//2 6//2\n"
+		"f 1/1/1 2/2/1 6/3/2\n";
+	ObjLoadOptions options;
+	options.numThreads = 2;
+	const ModelData expected = ParseObj(absolute, "");
+	const ModelData serial = ParseObj(relative, "");
+	const ModelData parallel = ParseObj(relative, "", options);
+	return expected.verticles.size() == 4 * 3 && serial.verticles.size() == expected.verticles.size() && parallel.verticles.size() == expected.verticles.size() &&
+		Hash(serial) == Hash(expected) && Hash(parallel) == Hash(expected);
+}
+
+// 範囲外のIndexを持つ面が読み飛ばされ、残りの面はそのまま読めるかを確認する
+// 0、読めない番号、先頭より前を指す相対参照、要素数を超える番号を、位置・UV・法線のそれぞれで試す
+bool CheckInvalidIndices() {
+	const string elements =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 0 1\n"
+		"vn 0 0 1\n";
+	const string invalid = elements +
+		"f 1/1/1 2/2/1 3/3/1\n"
+		"f 0 1 2\n"
+		"f x 2 3\n"
+		"f -5 -4 -3\n"
+		"f 1 2 5\n"
+		"f 1/4 2/2 3/3\n"
+		"f 1/-4 2/2 3/3\n"
+		"f 1//2 2//1 3//1\n"
+		"f 1//-2 2//1 3//1\n"
+		"f 1 2 9 3\n"
+		"f 2/2/1 4/2/1 3/3/1\n";
+	const string valid = elements +
+		"f 1/1/1 2/2/1 3/3/1\n"
+		"f 2/2/1 4/2/1 3/3/1\n";
+	ObjLoadOptions options;
+	options.indexed = true;
+	const ModelData expected = ParseObj(valid, "");
+	const ModelData expanded = ParseObj(invalid, "");
+	const ModelData indexed = ParseObj(invalid, "", options);
+	return expanded.verticles.size() == 2 * 3 && Hash(expanded) == Hash(expected) && indexed.indices.size() == 2 * 3 && indexed.verticles.size() == 4 &&
+		expanded.submeshes.size() == 1 && expanded.submeshes[0].indexCount == 2 * 3;
+}
+
+// 複数のオブジェクトとマテリアルを持つobjで、サブメッシュの範囲とマテリアルが正しいかを確認する
+// 同じテクスチャのサブメッシュが隣り合うことと、チャンクの境界をまたいで前のusemtlが引き継がれることも見る
+bool CheckSubmeshes(const filesystem::path& directory) {
+	const string mtlFilename = "MeshBenchmark_submesh.mtl";
+	{
+		ofstream mtl(directory / mtlFilename);
+		mtl << "newmtl matA\nmap_Kd a.png\n"
+			"newmtl matB\nmap_Kd b.png\n"
+			"newmtl matC\nmap_Kd a.png\n";
+	}
+	// k番目の三角形はz=kの3頂点を使う
+	string text = "mtllib " + mtlFilename + "\n";
+	for (int k = 0; k < 6; k++) {
+		text += "v 0 0 " + to_string(k) + "\nv 1 0 " + to_string(k) + "\nv 0 1 " + to_string(k) + "\n";
+	}
+	auto face = [](int k) { return "f " + to_string(k * 3 + 1) + " " + to_string(k * 3 + 2) + " " + to_string(k * 3 + 3) + "\n"; };
+	text += "o first\nusemtl matA\n" + face(0) + "usemtl matB\n" + face(1) +
+		"o second\nusemtl matC\n" + face(2) + "usemtl matA\n" + face(3);
+	// 区切りの後のチャンクは最初の面の前にusemtlもoもないので、second/matAを引き継ぐ
+	text += MakeObjPadding(3 << 20) + face(4) + "usemtl matB\n" + face(5);
+
+	// テクスチャのパス、マテリアル名、オブジェクト名の順に並ぶ
+	struct Expected {
+		const char* name;
+		const char* material;
+		vector<int> triangles; // 含まれる三角形（ファイルでの順）
+	};
+	const Expected expected[] = {
+		{ "first", "matA", { 0 } },
+		{ "second", "matA", { 3, 4 } },
+		{ "second", "matC", { 2 } },
+		{ "first", "matB", { 1 } },
+		{ "second", "matB", { 5 } },
+	};
+
+	bool valid = true;
+	for (uint32_t numThreads : { 1u, 2u }) {
+		for (bool indexed : { false, true }) {
+			ObjLoadOptions options;
+			options.numThreads = numThreads;
+			options.indexed = indexed;
+			const ModelData modelData = ParseObj(text, directory.string(), options);
+			const vector<VertexData> vertices = ExpandVertices(modelData);
+			if (modelData.submeshes.size() != size(expected) || vertices.size() != 6 * 3) {
+				valid = false;
+				continue;
+			}
+			uint32_t offset = 0;
+			for (size_t i = 0; i < modelData.submeshes.size(); i++) {
+				const SubmeshData& submesh = modelData.submeshes[i];
+				const uint32_t count = uint32_t(expected[i].triangles.size() * 3);
+				valid = valid && submesh.name == expected[i].name && modelData.materials[submesh.materialIndex].name == expected[i].material &&
+					submesh.indexOffset == offset && submesh.indexCount == count;
+				for (size_t t = 0; t < expected[i].triangles.size() && valid; t++) {
+					valid = vertices[offset + t * 3].position.z == float(expected[i].triangles[t]);
+				}
+				offset += count;
+			}
+			// 同じテクスチャのサブメッシュは、一度別のテクスチャに移ったら二度と出てこない
+			for (size_t i = 1; i < modelData.submeshes.size(); i++) {
+				const string& texture = modelData.materials[modelData.submeshes[i].materialIndex].textureFilePath;
+				if (texture != modelData.materials[modelData.submeshes[i - 1].materialIndex].textureFilePath) {
+					for (size_t j = 0; j + 1 < i; j++) {
+						valid = valid && modelData.materials[modelData.submeshes[j].materialIndex].textureFilePath != texture;
+					}
+				}
+			}
+		}
+	}
+	filesystem::remove(directory / mtlFilename);
+	return valid;
+}
+
+// .meshのIndexが頂点の範囲を超えていればOpenが失敗し、LoadModelFileがobjを読み直すことを確認する
+bool CheckMeshFileIndices(const filesystem::path& directory) {
+	const string objFilename = "MeshBenchmark_cooked.obj";
+	const filesystem::path objPath = directory / objFilename;
+	const filesystem::path cookedPath = directory / "MeshBenchmark_cooked.mesh";
+	{
+		ofstream obj(objPath);
+		obj << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\nf 2//1 4//1 3//1\n";
+	}
+	ObjLoadOptions options;
+	options.indexed = true;
+	const ModelData modelData = LoadObjFile(directory.string(), objFilename, options);
+	bool valid = WriteMeshFile(cookedPath.string(), modelData, directory.string());
+	{
+		MeshFile meshFile;
+		valid = valid && meshFile.Open(cookedPath.string());
+	}
+
+	// 最後のIndexを頂点数にして書き戻し、objより新しくしておく
+	string bytes;
+	{
+		ifstream file(cookedPath, ios::binary);
+		bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+	}
+	MeshFileHeader header;
+	memcpy(&header, bytes.data(), sizeof(header));
+	const size_t lastIndex = size_t(header.indexOffset) + size_t(header.indexSize) * (header.indexCount - 1);
+	if (header.indexSize == sizeof(uint16_t)) {
+		const uint16_t index = uint16_t(header.vertexCount);
+		memcpy(&bytes[lastIndex], &index, sizeof(index));
+	} else {
+		memcpy(&bytes[lastIndex], &header.vertexCount, sizeof(header.vertexCount));
+	}
+	{
+		ofstream file(cookedPath, ios::binary);
+		file.write(bytes.data(), streamsize(bytes.size()));
+	}
+	filesystem::last_write_time(cookedPath, filesystem::last_write_time(objPath) + chrono::hours(1));
+	{
+		MeshFile meshFile;
+		valid = valid && !meshFile.Open(cookedPath.string());
+	}
+	const ModelData loaded = LoadModelFile(directory.string(), objFilename);
+	valid = valid && loaded.indices.size() == 2 * 3 &&
+		all_of(loaded.indices.begin(), loaded.indices.end(), [&](uint32_t index) { return index < loaded.verticles.size(); });
+
+	filesystem::remove(objPath);
+	filesystem::remove(cookedPath);
+	return valid;
+}
+
+// 2つの単位ベクトルの間の角度（度）。小さな角度ではacos(Dot)の精度が足りないので、差の長さ（弦）から求める
+float AngleDegrees(const Vector3& a, const Vector3& b) {
+	const float chord = Length(Vector3{ a.x - b.x, a.y - b.y, a.z - b.z });
+	return 2.0f * asin(min(1.0f, chord * 0.5f)) * 180.0f / 3.14159265f;
+}
+
+// 球面全体の法線を八面体に展開して戻したときの最大誤差（度）を、浮動小数点数のままと16bitに量子化した場合で求める
+// 乱数の法線に加えて、折り返しの境目になる軸方向とz=0の円周上の法線も調べる
+void MeasureOctahedralError(float& maxFloatError, float& maxPackedError) {
+	vector<Vector3> normals;
+	for (int axis = 0; axis < 3; axis++) {
+		for (float sign : { 1.0f, -1.0f }) {
+			Vector3 normal = { 0.0f, 0.0f, 0.0f };
+			(axis == 0 ? normal.x : axis == 1 ? normal.y : normal.z) = sign;
+			normals.push_back(normal);
+		}
+	}
+	for (float z : { 0.0f, -0.0f }) {
+		for (int i = 0; i < 360; i++) {
+			const float angle = float(i) * 3.14159265f / 180.0f;
+			normals.push_back({ cos(angle), sin(angle), z });
+		}
+		for (float x : { 1.0f, -1.0f }) {
+			for (float y : { 1.0f, -1.0f }) {
+				normals.push_back(Normalize(Vector3{ x, y, z }));
+			}
+		}
+	}
+	// zを一様に、経度を一様に選ぶと球面上で一様になる
+	mt19937 engine(12345);
+	uniform_real_distribution<float> zDistribution(-1.0f, 1.0f);
+	uniform_real_distribution<float> angleDistribution(0.0f, 2.0f * 3.14159265f);
+	for (int i = 0; i < 1000000; i++) {
+		const float z = zDistribution(engine);
+		const float angle = angleDistribution(engine);
+		const float radius = sqrt(max(0.0f, 1.0f - z * z));
+		normals.push_back(Normalize(Vector3{ radius * cos(angle), radius * sin(angle), z }));
+	}
+
+	maxFloatError = 0.0f;
+	maxPackedError = 0.0f;
+	const VertexQuantization quantization = {};
+	for (const Vector3& normal : normals) {
+		maxFloatError = max(maxFloatError, AngleDegrees(normal, DecodeOctahedral(EncodeOctahedral(normal))));
+		VertexData vertex = {};
+		vertex.normal = normal;
+		maxPackedError = max(maxPackedError, AngleDegrees(normal, UnpackVertex(PackVertex(vertex, quantization), quantization).normal));
+	}
+}
+
+// 接線が三角形の+U方向を向き、wの符号が三角形の+V方向の側になっているかを確認する
+// 三角形ごとにUVの微分から接線と従法線を求め、頂点の法線に直交させたものと比べる。頂点の接線は周りの面の平均なので、向きの一致はminCosまで許す
+bool CheckTangentDirections(const ModelData& modelData, float minCos) {
+	const size_t cornerCount = modelData.indices.empty() ? modelData.verticles.size() : modelData.indices.size();
+	auto vertexOf = [&](size_t corner) { return modelData.indices.empty() ? uint32_t(corner) : modelData.indices[corner]; };
+	for (size_t corner = 0; corner + 2 < cornerCount; corner += 3) {
+		const uint32_t vertices[3] = { vertexOf(corner), vertexOf(corner + 1), vertexOf(corner + 2) };
+		Vector3 p[3];
+		for (int k = 0; k < 3; k++) {
+			const Vector4& position = modelData.verticles[vertices[k]].position;
+			p[k] = { position.x, position.y, position.z };
+		}
+		const Vector2& t0 = modelData.verticles[vertices[0]].texcoord;
+		const Vector2& t1 = modelData.verticles[vertices[1]].texcoord;
+		const Vector2& t2 = modelData.verticles[vertices[2]].texcoord;
+		const Vector3 e1 = p[1] - p[0], e2 = p[2] - p[0];
+		const float du1 = t1.x - t0.x, dv1 = t1.y - t0.y, du2 = t2.x - t0.x, dv2 = t2.y - t0.y;
+		const float det = du1 * dv2 - du2 * dv1;
+		if (det == 0.0f) {
+			continue;
+		}
+		const Vector3 faceTangent = (e1 * dv2 - e2 * dv1) * (1.0f / det);
+		const Vector3 faceBitangent = (e2 * du1 - e1 * du2) * (1.0f / det);
+		for (uint32_t vertex : vertices) {
+			const Vector3& normal = modelData.verticles[vertex].normal;
+			const Vector4& tangent = modelData.tangents[vertex];
+			const Vector3 tangentXyz = { tangent.x, tangent.y, tangent.z };
+			const Vector3 expected = Normalize(faceTangent - normal * Dot(normal, faceTangent));
+			const float expectedW = Dot(Cross(normal, tangentXyz), faceBitangent) < 0.0f ? -1.0f : 1.0f;
+			if (Dot(tangentXyz, expected) < minCos || tangent.w != expectedW) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// UVを左右反転した面を含むobjで、反転した面の接線が逆の+U方向を向き、wの符号が逆になるかを確認する
+// 反転した面は頂点を共有しない（継ぎ目で頂点を共有すると接線が打ち消し合う）
+bool CheckMirroredTangents() {
+	const string text =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 2 0 0\nv 3 0 0\nv 2 1 0\n"
+		"vt 0 0\nvt 1 0\nvt 0 1\nvt 1 0\nvt 0 0\nvt 1 1\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/2/1 3/3/1\n"
+		"f 4/4/1 5/5/1 6/6/1\n";
+	ObjLoadOptions options;
+	options.indexed = true;
+	options.generateTangents = true;
+	const ModelData modelData = ParseObj(text, "", options);
+	if (modelData.indices.size() != 2 * 3 || modelData.tangents.size() != modelData.verticles.size() || !CheckTangentDirections(modelData, 0.999f)) {
+		return false;
+	}
+	const Vector4& tangent = modelData.tangents[modelData.indices[0]];
+	const Vector4& mirrored = modelData.tangents[modelData.indices[3]];
+	return tangent.x * mirrored.x < 0.0f && tangent.w == -mirrored.w;
+}
+
+// 境界箱の形の視錐台。カリングの確認で、行列を作らずに見える範囲を決めるのに使う
+Frustum MakeBoxFrustum(const AABB& box) {
+	Frustum frustum;
+	frustum.planes[0] = { { 1.0f, 0.0f, 0.0f }, box.min.x };
+	frustum.planes[1] = { { -1.0f, 0.0f, 0.0f }, -box.max.x };
+	frustum.planes[2] = { { 0.0f, 1.0f, 0.0f }, box.min.y };
+	frustum.planes[3] = { { 0.0f, -1.0f, 0.0f }, -box.max.y };
+	frustum.planes[4] = { { 0.0f, 0.0f, 1.0f }, box.min.z };
+	frustum.planes[5] = { { 0.0f, 0.0f, -1.0f }, -box.max.z };
+	return frustum;
+}
+
+// LODの各段の三角形数が前の段を超えず、どの三角形も元の面に対して裏返っていないか
+// 元の面の向きは、位置から作り直した頂点の法線で比べる
+bool CheckLodChain(const ModelData& modelData, const vector<MeshLod>& lods) {
+	ModelData source = modelData;
+	GenerateNormals(source);
+	size_t previousTriangles = SIZE_MAX;
+	for (const MeshLod& lod : lods) {
+		size_t numTriangles = 0;
+		for (const SubmeshData& submesh : lod.submeshes) {
+			numTriangles += submesh.indexCount / 3;
+			for (size_t i = submesh.indexOffset; i + 2 < submesh.indexOffset + submesh.indexCount; i += 3) {
+				const VertexData& v0 = source.verticles[source.indices[i + 0]];
+				const VertexData& v1 = source.verticles[source.indices[i + 1]];
+				const VertexData& v2 = source.verticles[source.indices[i + 2]];
+				const Vector3 p0 = { v0.position.x, v0.position.y, v0.position.z };
+				const Vector3 p1 = { v1.position.x, v1.position.y, v1.position.z };
+				const Vector3 p2 = { v2.position.x, v2.position.y, v2.position.z };
+				if (Dot(Cross(p1 - p0, p2 - p0), v0.normal + v1.normal + v2.normal) <= 0.0f) {
+					return false;
+				}
+			}
+		}
+		if (numTriangles > previousTriangles) {
+			return false;
+		}
+		previousTriangles = numTriangles;
+	}
+	return true;
+}
+
+// 三角形ごとに頂点を分け、面の法線を持たせたフラットシェーディングのメッシュにする
+ModelData MakeFlatShaded(const ModelData& modelData, const SubmeshData& submesh) {
+	ModelData flatShaded;
+	for (size_t i = submesh.indexOffset; i + 2 < submesh.indexOffset + submesh.indexCount; i += 3) {
+		VertexData corners[3] = { modelData.verticles[modelData.indices[i]], modelData.verticles[modelData.indices[i + 1]], modelData.verticles[modelData.indices[i + 2]] };
+		const Vector3 p0 = { corners[0].position.x, corners[0].position.y, corners[0].position.z };
+		const Vector3 p1 = { corners[1].position.x, corners[1].position.y, corners[1].position.z };
+		const Vector3 p2 = { corners[2].position.x, corners[2].position.y, corners[2].position.z };
+		const Vector3 normal = Normalize(Cross(p1 - p0, p2 - p0));
+		for (VertexData& corner : corners) {
+			corner.normal = normal;
+			flatShaded.indices.push_back(uint32_t(flatShaded.verticles.size()));
+			flatShaded.verticles.push_back(corner);
+		}
+	}
+	SubmeshData flatSubmesh = submesh;
+	flatSubmesh.indexOffset = 0;
+	flatSubmesh.indexCount = uint32_t(flatShaded.indices.size());
+	flatShaded.submeshes.push_back(flatSubmesh);
+	return flatShaded;
+}
+
+// 少し待つ読み込みでAssetLoaderを確認する
+// 既定のスレッド数、まとめて取り出した完了を終わった順に呼ぶこと、WaitAll、破棄時に終わっていた読み込みだけを破棄時の関数に渡すこと
+bool CheckAssetLoader() {
+	bool valid = true;
+	{
+		AssetLoader loader;
+		valid = valid && loader.GetThreadCount() == max(2u, thread::hardware_concurrency()) - 1;
+	}
+
+	auto sleepLoad = [](atomic<int>& loaded, int value) {
+		return [&loaded, value]() {
+			this_thread::sleep_for(chrono::milliseconds(10));
+			loaded++;
+			return value;
+		};
+	};
+	{
+		// 1スレッドなので終わる順は要求した順。すべて終わってから1回のUpdateで取り出す
+		AssetLoader loader(1);
+		atomic<int> loaded = 0;
+		vector<int> order;
+		for (int i = 0; i < 4; i++) {
+			loader.Request(sleepLoad(loaded, i), [&](int&& value) { order.push_back(value); });
+		}
+		while (loaded < 4) {
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+		valid = valid && loader.Update() == 4 && order == vector<int>{ 0, 1, 2, 3 } && loader.GetPendingCount() == 0;
+	}
+	{
+		AssetLoader loader(2);
+		atomic<int> loaded = 0;
+		int completed = 0;
+		for (int i = 0; i < 8; i++) {
+			loader.Request(sleepLoad(loaded, i), [&](int&&) { completed++; });
+		}
+		loader.WaitAll();
+		valid = valid && completed == 8 && loaded == 8 && loader.GetPendingCount() == 0;
+	}
+	{
+		// 1つ目が終わった後で破棄する。終わっていたものは破棄時の関数に、始まっていないものはどちらにも渡らない
+		atomic<int> loaded = 0;
+		int completed = 0;
+		int discarded = 0;
+		{
+			AssetLoader loader(1);
+			for (int i = 0; i < 4; i++) {
+				loader.Request(sleepLoad(loaded, i), [&](int&&) { completed++; }, [&](int&&) { discarded++; });
+			}
+			while (loaded < 1) {
+				this_thread::sleep_for(chrono::milliseconds(1));
+			}
+		}
+		valid = valid && completed == 0 && discarded == loaded && loaded >= 1 && loaded < 4;
+	}
+	return valid;
+}
+
+// 小さな一時ファイルでAssetRegistryを確認する
+// パスの正規化、別のパスで中身が同じものの共有、中身のキーが同じでもバイト列が違うものを分けること、参照数、
+// 予算を超えたときに参照されていないものだけを使われていない順に捨てること、LoadAsyncがワーカーで共有を見つけること
+bool CheckAssetRegistry(const filesystem::path& directory) {
+	const filesystem::path root = directory / "MeshBenchmark_assets";
+	filesystem::create_directories(root / "sub");
+	auto writeFile = [&](const char* name, const char* contents) {
+		ofstream file(root / name, ios::binary);
+		file << contents;
+	};
+	auto path = [&](const char* name) { return (root / name).string(); };
+	writeFile("a.bin", "hello");
+	writeFile("b.bin", "hello");
+	writeFile("c.bin", "world");
+	writeFile("d.bin", "hello");
+	writeFile("x1.bin", "x1");
+	writeFile("x2.bin", "x2");
+	writeFile("x3.bin", "x3");
+
+	struct Asset {
+		string contents;
+	};
+	int loadCount = 0;
+	int releaseCount = 0;
+	auto load = [&](const string&, string_view contents) {
+		loadCount++;
+		return Asset{ string(contents) };
+	};
+	bool valid = true;
+	{
+		AssetRegistry<Asset> registry([](const Asset&) { return size_t(100); }, SIZE_MAX, [&](Asset&) { releaseCount++; });
+		// 同じファイルを指す別の書き方と、中身が同じ別のファイルは1度しか読み込まない
+		AssetRegistry<Asset>::Handle a = registry.Load(path("a.bin"), load);
+		AssetRegistry<Asset>::Handle a2 = registry.Load((root / "sub" / ".." / "a.bin").string(), load);
+		AssetRegistry<Asset>::Handle b = registry.Load(path("b.bin"), load);
+		AssetRegistry<Asset>::Handle c = registry.Load(path("c.bin"), load);
+		valid = valid && a == a2 && a == b && a != c && loadCount == 2 && registry.GetCount() == 2;
+		valid = valid && registry.GetReferenceCount(path("a.bin")) == 3 && registry.GetReferenceCount(path("c.bin")) == 1 &&
+			registry.GetReferenceCount(path("missing.bin")) == 0;
+
+		// 読み込んだファイルが書き換わると、キーが同じでもバイト列が違う。ハッシュが衝突したときと同じく別のアセットにする
+		writeFile("a.bin", "jello");
+		AssetRegistry<Asset>::Handle d = registry.Load(path("d.bin"), load);
+		valid = valid && d != a && d->contents == "hello" && loadCount == 3 && registry.GetCount() == 3;
+	}
+	valid = valid && releaseCount == 3;
+
+	{
+		releaseCount = 0;
+		AssetRegistry<Asset> registry([](const Asset&) { return size_t(100); }, 250, [&](Asset&) { releaseCount++; });
+		// 参照されている間は予算を超えても捨てない
+		AssetRegistry<Asset>::Handle x1 = registry.Load(path("x1.bin"), load);
+		AssetRegistry<Asset>::Handle x2 = registry.Load(path("x2.bin"), load);
+		AssetRegistry<Asset>::Handle x3 = registry.Load(path("x3.bin"), load);
+		valid = valid && registry.GetCount() == 3 && registry.GetMemoryUsage() == 300;
+		// 手放しただけでは捨てず、Trimで使われていない順に予算まで捨てる。x1は後で使ったので残る
+		x1 = x2 = x3 = nullptr;
+		valid = valid && registry.GetCount() == 3;
+		registry.Find(path("x1.bin"));
+		registry.Trim();
+		valid = valid && registry.GetCount() == 2 && releaseCount == 1 && !registry.Find(path("x2.bin"));
+		x3 = registry.Find(path("x3.bin"));
+		registry.SetMemoryBudget(0);
+		valid = valid && registry.GetCount() == 1 && releaseCount == 2 && registry.Find(path("x3.bin")) == x3 && registry.GetMemoryUsage() == 100;
+	}
+
+	{
+		// 要求した時点で中身が同じものが登録されていれば、ワーカーで比べてloadを呼ばない
+		AssetLoader loader(1);
+		AssetRegistry<Asset> registry([](const Asset&) { return size_t(100); });
+		AssetRegistry<Asset>::Handle c = registry.Load(path("c.bin"), load);
+		writeFile("e.bin", "world");
+		loadCount = 0;
+		AssetRegistry<Asset>::Handle e;
+		registry.LoadAsync(loader, path("e.bin"), load, [](Asset&& asset) { return std::move(asset); },
+			[&](const AssetRegistry<Asset>::Handle& loaded) { e = loaded; });
+		loader.WaitAll();
+		valid = valid && e == c && loadCount == 0 && registry.GetReferenceCount(path("e.bin")) == 2;
+	}
+
+	filesystem::remove_all(root);
+	return valid;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	const size_t numTriangles = argc > 1 ? size_t(strtoull(argv[1], nullptr, 10)) : 10000000;
+
+	// ベンチマーク用のobjを一時ディレクトリに生成する
+	const filesystem::path directory = filesystem::temp_directory_path();
+	const string filename = "MeshBenchmark.obj";
+	printf("generating %zu triangles...\n", numTriangles);
+	WriteGridObj(directory / filename, numTriangles);
+	const double megabytes = double(filesystem::file_size(directory / filename)) / (1024.0 * 1024.0);
+	printf("%.1f MB\n", megabytes);
+
+	int exitCode = 0;
+	if (!CheckPartialNormals(false) || !CheckPartialNormals(true)) {
+		printf("NG: authored normals are overwritten by generated normals\n");
+		exitCode = 1;
+	}
+	if (!CheckFaceFormats()) {
+		printf("NG: faces are not parsed as written in every v/vt/vn format\n");
+		exitCode = 1;
+	}
+	if (!CheckConcavePolygon()) {
+		printf("NG: concave polygon is not triangulated with a consistent winding and area\n");
+		exitCode = 1;
+	}
+	if (!CheckRelativeIndices()) {
+		printf("NG: relative indices across a chunk boundary differ from absolute indices\n");
+		exitCode = 1;
+	}
+	if (!CheckInvalidIndices()) {
+		printf("NG: faces with out-of-range indices were not skipped\n");
+		exitCode = 1;
+	}
+	if (!CheckSubmeshes(directory)) {
+		printf("NG: submesh ranges or materials are wrong\n");
+		exitCode = 1;
+	}
+	if (!CheckMirroredTangents()) {
+		printf("NG: tangents of a mirrored-UV face do not flip\n");
+		exitCode = 1;
+	}
+	if (!CheckMeshFileIndices(directory)) {
+		printf("NG: a .mesh file with an out-of-range index was not rejected\n");
+		exitCode = 1;
+	}
+	if (!CheckAssetLoader()) {
+		printf("NG: asset loader does not complete, wait for or discard loads as expected\n");
+		exitCode = 1;
+	}
+	if (!CheckAssetRegistry(directory)) {
+		printf("NG: asset registry does not share, separate or evict assets as expected\n");
+		exitCode = 1;
+	}
+	float octahedralFloatError, octahedralPackedError;
+	MeasureOctahedralError(octahedralFloatError, octahedralPackedError);
+	printf("octahedral normals  max error %g deg (float)  %g deg (16-bit)\n", octahedralFloatError, octahedralPackedError);
+	if (octahedralFloatError > 0.001f || octahedralPackedError > 0.01f) {
+		printf("NG: octahedral normals do not round-trip over the sphere\n");
+		exitCode = 1;
+	}
+
+	const Result legacy = Measure([&]() { return LoadObjFileLegacy(directory.string(), filename); });
+	Report("istringstream (legacy)", legacy, megabytes);
+	const Result current = Measure([&]() { return LoadObjFile(directory.string(), filename); });
+	Report("LoadObjFile", current, megabytes);
+	if (current.hash != legacy.hash || current.numVertices != legacy.numVertices) {
+		printf("NG: result differs from the legacy loader\n");
+		exitCode = 1;
+	}
+
+	// スレッド数を倍にしながら並列解析を計測する。1コアの環境でも結果の一致は確認する
+	const uint32_t maxThreads = max(2u, thread::hardware_concurrency());
+	vector<uint32_t> threadCounts;
+	for (uint32_t numThreads = 2; numThreads < maxThreads; numThreads *= 2) {
+		threadCounts.push_back(numThreads);
+	}
+	threadCounts.push_back(maxThreads);
+	for (uint32_t numThreads : threadCounts) {
+		ObjLoadOptions options;
+		options.numThreads = numThreads;
+		const Result parallel = Measure([&]() { return LoadObjFile(directory.string(), filename, options); });
+		char name[64];
+		snprintf(name, sizeof(name), "LoadObjFile (%u threads)", numThreads);
+		Report(name, parallel, megabytes);
+		printf("%-24s %8.2fx\n", "  speedup", current.seconds / parallel.seconds);
+		if (parallel.hash != current.hash || parallel.numVertices != current.numVertices) {
+			printf("NG: parallel result differs from the serial result\n");
+			exitCode = 1;
+		}
+	}
+
+	// Index付きで読み込み、展開すると元の頂点列と一致するかを確認する
+	// 頂点をまとめる処理も並列なので、1スレッドと比べた速度と結果の一致も見る
+	{
+		ObjLoadOptions options;
+		options.indexed = true;
+		auto start = chrono::steady_clock::now();
+		const ModelData serialIndexed = LoadObjFile(directory.string(), filename, options);
+		auto end = chrono::steady_clock::now();
+		const double serialSeconds = chrono::duration<double>(end - start).count();
+		Report("LoadObjFile (indexed, 1)", { serialSeconds, serialIndexed.verticles.size(), Hash(serialIndexed) }, megabytes);
+
+		options.numThreads = maxThreads;
+		start = chrono::steady_clock::now();
+		ModelData indexed = LoadObjFile(directory.string(), filename, options);
+		end = chrono::steady_clock::now();
+		printf("%-24s %8.2fx  (%u threads)\n", "  speedup", serialSeconds / chrono::duration<double>(end - start).count(), maxThreads);
+		if (Hash(indexed) != Hash(serialIndexed) || indexed.indices != serialIndexed.indices) {
+			printf("NG: parallel indexed result differs from the serial result\n");
+			exitCode = 1;
+		}
+		ModelData expanded;
+		expanded.verticles.reserve(indexed.indices.size());
+		for (uint32_t index : indexed.indices) {
+			expanded.verticles.push_back(indexed.verticles[index]);
+		}
+		const Result result = { chrono::duration<double>(end - start).count(), indexed.verticles.size(), Hash(expanded) };
+		Report("LoadObjFile (indexed)", result, megabytes);
+		const size_t indexSize = CanUse16BitIndices(indexed) ? sizeof(uint16_t) : sizeof(uint32_t);
+		printf("  vertex + index size %.1f MB -> %.1f MB (%zu-bit indices)\n",
+			double(current.numVertices * sizeof(VertexData)) / (1024.0 * 1024.0),
+			double(indexed.verticles.size() * sizeof(VertexData) + indexed.indices.size() * indexSize) / (1024.0 * 1024.0), indexSize * 8);
+		if (result.hash != current.hash || indexed.indices.size() != current.numVertices) {
+			printf("NG: indexed result differs from the expanded result\n");
+			exitCode = 1;
+		}
+
+		// 頂点キャッシュ向けに並べ替え、FIFOキャッシュを再現してACMR/ATVRを比べる
+		const VertexCacheStatistics before = AnalyzeVertexCache(indexed.indices, indexed.verticles.size());
+		const uint64_t trianglesHash = HashTriangles(indexed);
+		start = chrono::steady_clock::now();
+		OptimizeMesh(indexed);
+		end = chrono::steady_clock::now();
+		const VertexCacheStatistics after = AnalyzeVertexCache(indexed.indices, indexed.verticles.size());
+		printf("%-24s %8.3f s  (cache size %u)\n", "OptimizeMesh", chrono::duration<double>(end - start).count(), kVertexCacheSize);
+		printf("  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+		if (HashTriangles(indexed) != trianglesHash || after.vertexTransformCount > before.vertexTransformCount) {
+			printf("NG: optimized mesh lost triangles or got worse\n");
+			exitCode = 1;
+		}
+
+		// LODを作り、段ごとの三角形数と誤差を表示する
+		start = chrono::steady_clock::now();
+		const vector<MeshLod> lods = BuildLodChain(indexed);
+		end = chrono::steady_clock::now();
+		printf("%-24s %8.3f s\n", "BuildLodChain", chrono::duration<double>(end - start).count());
+		for (size_t lod = 0; lod < lods.size(); lod++) {
+			size_t numLodTriangles = 0;
+			for (const SubmeshData& submesh : lods[lod].submeshes) {
+				numLodTriangles += submesh.indexCount / 3;
+			}
+			printf("  LOD%zu %12zu triangles  error %g\n", lod, numLodTriangles, lods[lod].error);
+		}
+		if (!CheckLodChain(indexed, lods)) {
+			printf("NG: a LOD has more triangles than the previous one or flipped triangles\n");
+			exitCode = 1;
+		}
+		// 遠くなるほど同じか粗いLODを選ぶこと。SelectLodが使うのは射影行列のm[1][1]だけ
+		{
+			Matrix4x4 projection = {};
+			projection.m[1][1] = 1.0f / tan(0.45f * 0.5f);
+			size_t previousLod = 0;
+			bool selectValid = true;
+			for (float distance = 0.1f; distance < 1000.0f; distance *= 1.25f) {
+				const size_t lod = SelectLod(lods, distance, projection, 720.0f);
+				selectValid = selectValid && lod >= previousLod && lod < lods.size();
+				previousLod = lod;
+			}
+			if (!selectValid || previousLod != lods.size() - 1) {
+				printf("NG: SelectLod picks a finer LOD at a larger distance\n");
+				exitCode = 1;
+			}
+		}
+		// 全部の頂点が継ぎ目にあるフラットシェーディングのメッシュでもLODができること
+		{
+			ModelData flatShaded = MakeFlatShaded(indexed, lods[0].submeshes[0]);
+			const vector<MeshLod> flatLods = BuildLodChain(flatShaded);
+			size_t numFlatTriangles = 0;
+			for (const SubmeshData& submesh : flatLods.back().submeshes) {
+				numFlatTriangles += submesh.indexCount / 3;
+			}
+			printf("  flat shaded  %zu LODs  coarsest %zu triangles  error %g\n", flatLods.size(), numFlatTriangles, flatLods.back().error);
+			if (flatLods.size() < 2 || !CheckLodChain(flatShaded, flatLods)) {
+				printf("NG: flat shaded mesh produced no LOD or an invalid one\n");
+				exitCode = 1;
+			}
+		}
+
+		// 元のメッシュをメッシュレットに分け、三角形が漏れなく上限内に収まっているかを確認する
+		start = chrono::steady_clock::now();
+		const MeshletData meshletData = BuildMeshlets(indexed, lods[0].submeshes);
+		end = chrono::steady_clock::now();
+		size_t numMeshletTriangles = 0;
+		bool meshletsValid = true;
+		for (const Meshlet& meshlet : meshletData.meshlets) {
+			numMeshletTriangles += meshlet.triangleCount;
+			meshletsValid = meshletsValid && meshlet.vertexCount <= kMeshletMaxVertices && meshlet.triangleCount <= kMeshletMaxTriangles;
+		}
+		printf("%-24s %8.3f s %10zu meshlets  %.1f vertices  %.1f triangles / meshlet\n", "BuildMeshlets", chrono::duration<double>(end - start).count(),
+			meshletData.meshlets.size(), double(meshletData.vertices.size()) / double(meshletData.meshlets.size()), double(numMeshletTriangles) / double(meshletData.meshlets.size()));
+		if (!meshletsValid || numMeshletTriangles * 3 != lods[0].submeshes[0].indexCount) {
+			printf("NG: meshlets lost triangles or exceed the limits\n");
+			exitCode = 1;
+		}
+
+		// 格子を平らにしてメッシュレットのカリングを確認する
+		// 読み込んだ面は法線（+z）の側から見て時計回りなので、D3DのCullMode BACKで描かれるのは+z側から見たとき
+		// 法線の側にいるカメラではすべて残り、反対側ではすべて裏向きで除かれ、視錐台が外れていればすべて除かれる
+		{
+			ModelData flat = indexed;
+			for (VertexData& vertex : flat.verticles) {
+				vertex.position.z = 0.0f;
+			}
+			const MeshletData flatMeshlets = BuildMeshlets(flat, lods[0].submeshes);
+			auto countVisible = [&](const AABB& box, const Vector3& cameraPosition) {
+				vector<uint8_t> visible(flatMeshlets.meshlets.size(), 0);
+				CullMeshlets(flatMeshlets, MakeBoxFrustum(box), cameraPosition, visible);
+				return size_t(count(visible.begin(), visible.end(), uint8_t(1)));
+			};
+			const AABB around = { { -2.0f, -2.0f, -10.0f }, { 2.0f, 2.0f, 10.0f } };
+			const AABB away = { { 10.0f, 10.0f, -10.0f }, { 12.0f, 12.0f, 10.0f } };
+			const size_t front = countVisible(around, { 0.0f, 0.0f, 5.0f });
+			const size_t behind = countVisible(around, { 0.0f, 0.0f, -5.0f });
+			const size_t outside = countVisible(away, { 0.0f, 0.0f, 5.0f });
+			printf("  CullMeshlets  front %zu  behind %zu  outside frustum %zu / %zu meshlets\n", front, behind, outside, flatMeshlets.meshlets.size());
+			bool cullValid = front == flatMeshlets.meshlets.size() && behind == 0 && outside == 0;
+			// 元のメッシュの三角形の面の向きが、書かれた法線と同じ側であること
+			for (const SubmeshData& submesh : lods[0].submeshes) {
+				for (size_t i = submesh.indexOffset; i + 2 < submesh.indexOffset + submesh.indexCount && cullValid; i += 3) {
+					const Vector4& p0 = flat.verticles[flat.indices[i + 0]].position;
+					const Vector4& p1 = flat.verticles[flat.indices[i + 1]].position;
+					const Vector4& p2 = flat.verticles[flat.indices[i + 2]].position;
+					const float crossZ = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+					cullValid = crossZ > 0.0f && flat.verticles[flat.indices[i]].normal.z > 0.0f;
+				}
+			}
+			if (!cullValid) {
+				printf("NG: meshlet culling keeps back-facing or off-screen meshlets, or rejects visible ones\n");
+				exitCode = 1;
+			}
+		}
+
+		// 読み込み時に求めた境界が、サブメッシュの頂点をすべて囲んでいるかを確認する
+		start = chrono::steady_clock::now();
+		const MeshBounds bounds = ComputeMeshBounds(indexed.verticles);
+		end = chrono::steady_clock::now();
+		printf("%-24s %8.3f s  sphere radius %g (half diagonal %g)\n", "ComputeMeshBounds", chrono::duration<double>(end - start).count(),
+			bounds.sphere.radius, Length(bounds.aabb.max - bounds.aabb.min) * 0.5f);
+		bool boundsValid = true;
+		for (const SubmeshData& submesh : indexed.submeshes) {
+			for (size_t i = submesh.indexOffset; i < submesh.indexOffset + submesh.indexCount; i++) {
+				const Vector4& p = indexed.verticles[indexed.indices[i]].position;
+				const Vector3 position = { p.x, p.y, p.z };
+				for (const MeshBounds& b : { indexed.bounds, submesh.bounds }) {
+					boundsValid = boundsValid && Length(position - b.sphere.center) <= b.sphere.radius * 1.0001f + 1e-6f &&
+						position.x >= b.aabb.min.x && position.y >= b.aabb.min.y && position.z >= b.aabb.min.z &&
+						position.x <= b.aabb.max.x && position.y <= b.aabb.max.y && position.z <= b.aabb.max.z;
+				}
+			}
+		}
+		if (!boundsValid) {
+			printf("NG: bounds do not contain the vertices\n");
+			exitCode = 1;
+		}
+
+		// 頂点を圧縮して戻し、位置・法線・UVの誤差が量子化の幅に収まっているかを確認する
+		start = chrono::steady_clock::now();
+		const VertexQuantization quantization = MakeVertexQuantization(indexed.bounds.aabb);
+		const vector<PackedVertexData> packed = PackVertices(indexed.verticles, quantization);
+		end = chrono::steady_clock::now();
+		float maxPositionError = 0.0f, maxNormalError = 0.0f, maxTexcoordError = 0.0f;
+		bool packedValid = true;
+		for (size_t i = 0; i < packed.size(); i++) {
+			const VertexData& original = indexed.verticles[i];
+			const VertexData unpacked = UnpackVertex(packed[i], quantization);
+			// 位置は量子化の幅の半分、UVは半精度の仮数の最下位の半分まで
+			const float positionError[3] = { abs(unpacked.position.x - original.position.x), abs(unpacked.position.y - original.position.y), abs(unpacked.position.z - original.position.z) };
+			const float positionStep[3] = { quantization.scale.x / 65535.0f, quantization.scale.y / 65535.0f, quantization.scale.z / 65535.0f };
+			for (int axis = 0; axis < 3; axis++) {
+				maxPositionError = max(maxPositionError, positionError[axis]);
+				packedValid = packedValid && positionError[axis] <= positionStep[axis] * 0.5f + 1e-6f;
+			}
+			const float texcoordError[2] = { abs(unpacked.texcoord.x - original.texcoord.x), abs(unpacked.texcoord.y - original.texcoord.y) };
+			const float texcoord[2] = { abs(original.texcoord.x), abs(original.texcoord.y) };
+			for (int axis = 0; axis < 2; axis++) {
+				maxTexcoordError = max(maxTexcoordError, texcoordError[axis]);
+				packedValid = packedValid && texcoordError[axis] <= max(texcoord[axis], 1.0f / 16384.0f) / 2048.0f;
+			}
+			const float normalError = acos(min(1.0f, Dot(Normalize(original.normal), unpacked.normal))) * 180.0f / 3.14159265f;
+			maxNormalError = max(maxNormalError, normalError);
+			packedValid = packedValid && normalError <= 0.1f;
+		}
+		printf("%-24s %8.3f s  %zu -> %zu bytes / vertex\n", "PackVertices", chrono::duration<double>(end - start).count(), sizeof(VertexData), sizeof(PackedVertexData));
+		printf("  max error  position %g  normal %g deg  texcoord %g\n", maxPositionError, maxNormalError, maxTexcoordError);
+		if (!packedValid) {
+			printf("NG: packed vertices exceed the quantization error\n");
+			exitCode = 1;
+		}
+
+		// 法線と接線を作り直し、スレッド数によらず同じ結果で、接線が法線に直交した単位ベクトルになっているかを確認する
+		// 後ろに足したLODの三角形は除き、元のメッシュだけで作る
+		ModelData source = indexed;
+		source.indices.resize(lods[0].submeshes.back().indexOffset + lods[0].submeshes.back().indexCount);
+		ModelData generated = source;
+		start = chrono::steady_clock::now();
+		GenerateNormals(generated, maxThreads);
+		GenerateTangents(generated, maxThreads);
+		end = chrono::steady_clock::now();
+		printf("%-24s %8.3f s  (%u threads)\n", "GenerateTangents", chrono::duration<double>(end - start).count(), maxThreads);
+		ModelData serial = source;
+		GenerateNormals(serial, 1);
+		GenerateTangents(serial, 1);
+		bool tangentsValid = Hash(serial) == Hash(generated) && serial.tangents.size() == generated.verticles.size() &&
+			memcmp(serial.tangents.data(), generated.tangents.data(), sizeof(Vector4) * serial.tangents.size()) == 0;
+		for (size_t i = 0; i < generated.verticles.size() && tangentsValid; i++) {
+			const Vector3& normal = generated.verticles[i].normal;
+			const Vector3 tangent = { generated.tangents[i].x, generated.tangents[i].y, generated.tangents[i].z };
+			tangentsValid = abs(Length(normal) - 1.0f) < 1e-4f && abs(Length(tangent) - 1.0f) < 1e-4f && abs(Dot(normal, tangent)) < 1e-4f &&
+				abs(generated.tangents[i].w) == 1.0f;
+		}
+		// グリッドのUVは位置に沿って単調なので、接線は面の+U方向に近く、wは面の+V方向の側になる
+		tangentsValid = tangentsValid && CheckTangentDirections(generated, 0.7f);
+		if (!tangentsValid) {
+			printf("NG: generated tangent space is not orthonormal, does not follow the UVs or depends on the thread count\n");
+			exitCode = 1;
+		}
+	}
+
+	filesystem::remove(directory / filename);
+	return exitCode;
+}
@@ -0,0 +1,69 @@
+// objを変換済みメッシュファイル（.mesh）に変換する
+// 使い方: MeshCooker [ディレクトリ（既定はresources）] [-f]
+//   ディレクトリ内のobjのうち、.meshがないかobjより古いものを変換する。-fならすべて変換し直す
+//   変換時に接線を作り、頂点キャッシュ向けの並べ替えをかけて、前後のACMR/ATVRを表示する
+// Windows以外でも以下のようにビルドできる
+//   g++ -std=c++20 -O2 -I../.. -I../../engine/math main.cpp ../../engine/3d/MeshBounds.cpp ../../engine/3d/MeshOptimizer.cpp ../../engine/3d/TangentSpace.cpp ../../engine/io/*.cpp ../../engine/math/Geometry.cpp
+#include "engine/3d/MeshOptimizer.h"
+#include "engine/io/MeshFile.h"
+#include "engine/io/ObjLoader.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+	string directoryPath = "resources";
+	bool force = false;
+	for (int i = 1; i < argc; i++) {
+		if (string(argv[i]) == "-f") {
+			force = true;
+		} else {
+			directoryPath = argv[i];
+		}
+	}
+
+	error_code errorCode;
+	filesystem::directory_iterator iterator(directoryPath, errorCode);
+	if (errorCode) {
+		printf("cannot open %s\n", directoryPath.c_str());
+		return 1;
+	}
+
+	int exitCode = 0;
+	for (const filesystem::directory_entry& entry : iterator) {
+		const filesystem::path& sourcePath = entry.path();
+		if (!entry.is_regular_file() || sourcePath.extension() != ".obj") {
+			continue;
+		}
+		filesystem::path cookedPath = sourcePath;
+		cookedPath.replace_extension(".mesh");
+		if (!force && filesystem::exists(cookedPath) && filesystem::last_write_time(cookedPath) >= filesystem::last_write_time(sourcePath)) {
+			printf("%-32s up to date\n", sourcePath.filename().string().c_str());
+			continue;
+		}
+
+		auto start = chrono::steady_clock::now();
+		ObjLoadOptions options;
+		options.numThreads = 0;
+		options.indexed = true;
+		options.generateTangents = true;
+		ModelData modelData = LoadObjFile(directoryPath, sourcePath.filename().string(), options);
+		const VertexCacheStatistics before = AnalyzeVertexCache(modelData.indices, modelData.verticles.size());
+		OptimizeMesh(modelData);
+		const VertexCacheStatistics after = AnalyzeVertexCache(modelData.indices, modelData.verticles.size());
+		if (!WriteMeshFile(cookedPath.string(), modelData, directoryPath)) {
+			printf("%-32s failed to write %s\n", sourcePath.filename().string().c_str(), cookedPath.string().c_str());
+			exitCode = 1;
+			continue;
+		}
+		auto end = chrono::steady_clock::now();
+		printf("%-32s %8zu vertices %8zu indices %4zu submeshes  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f %8.1f ms\n", sourcePath.filename().string().c_str(),
+			modelData.verticles.size(), modelData.indices.size(), modelData.submeshes.size(), before.acmr, after.acmr, before.atvr, after.atvr,
+			chrono::duration<double, milli>(end - start).count());
+	}
+
+	return exitCode;
+}